@@ -109,6 +109,9 @@ static void updatePopulationFitness(Species *species, long epoch)
 	}
 
 	shiftFitnesses(species);
+
+	species -> state.indexBest = indexBest(species);
+	species -> state.indexWorst = -1;
 }
 
 
@@ -139,36 +142,143 @@ inline static int selection(const Species *species, rng32 *rng)
 
 
 // Replacing the worst gene by a new one if the latter is better, and if so updates the sum of fitnesses
-// and 'index_worst'. Also, assures that no negative fitness can be added when using SEL_PROPORTIONATE.
-static void replaceWorst(Species *species, int *index_worst, double new_fitness, long epoch, long *epoch_last_update)
+// and the search state. Also, assures that no negative fitness can be added when using SEL_PROPORTIONATE.
+static void replaceWorst(Species *species, double new_fitness)
 {
-	if (*index_worst < 0) {
-		*index_worst = indexWorst(species); // Searching for the gene of lower fitness.
+	SearchState *state = &(species -> state);
+
+	if (state -> indexWorst < 0) {
+		state -> indexWorst = indexWorst(species); // Searching for the gene of lower fitness.
 	}
 
-	if (new_fitness > species -> fitnessArray[*index_worst]) // optimization!
+	const int index_worst = state -> indexWorst;
+
+	if (new_fitness > species -> fitnessArray[index_worst]) // optimization!
 	{
 		// Updating the sum of the fitness values:
-		species -> sumFitnesses += new_fitness - species -> fitnessArray[*index_worst];
+		species -> sumFitnesses += new_fitness - species -> fitnessArray[index_worst];
 
 		// Updating the length of the new gene:
-		species -> fitnessArray[*index_worst] = new_fitness;
+		species -> fitnessArray[index_worst] = new_fitness;
 
 		// Replacing the worst gene:
-		species -> genMeth -> copyGene(species -> context, species -> population[*index_worst], species -> geneBuffer);
+		if (GL_OWNERSHIP_TRANSFER)
+		{
+			void *worst_gene = species -> population[index_worst];
+			species -> population[index_worst] = species -> geneBuffer;
+			species -> geneBuffer = worst_gene; // to be overwritten by the next offspring.
+		}
+		else
+			species -> genMeth -> copyGene(species -> context, species -> population[index_worst], species -> geneBuffer);
+
+		if (new_fitness > species -> fitnessArray[state -> indexBest])
+		{
+			state -> indexBest = index_worst;
+			state -> epochLastImprovement = state -> epoch;
+		}
+
+		state -> epochLastUpdate = state -> epoch;
+		++(state -> acceptedNumber);
+
+		state -> indexWorst = -1; // index_worst will need to be found again.
+	}
+}
+
+
+// Checks whether the search stagnates, according to the restart policy:
+static int isStagnating(const Species *species)
+{
+	const RestartPolicy *policy = &(species -> genMeth -> restartPolicy);
+	const SearchState *state = &(species -> state);
+
+	if (policy -> stagnationEpochs > 0 && state -> epoch - state -> epochLastImprovement >= policy -> stagnationEpochs)
+		return 1;
+
+	if (policy -> minRelativeDeviation > 0. && state -> epoch % species -> populationSize == 0)
+	{
+		const double mean = species -> sumFitnesses / species -> populationSize; // shifted.
+		double variance = 0.;
+
+		for (int i = 0; i < species -> populationSize; ++i)
+		{
+			double deviation = species -> fitnessArray[i] - mean;
+			variance += deviation * deviation;
+		}
+
+		variance /= species -> populationSize;
+
+		return sqrt(variance) < policy -> minRelativeDeviation * fabs(mean - species -> fitnessShift);
+	}
+
+	return 0;
+}
+
+
+// Checks whether the best gene reaches the target fitness:
+static inline int targetReached(const Species *species)
+{
+	return species -> fitnessArray[species -> state.indexBest] - species -> fitnessShift >= species -> targetFitness;
+}
+
+
+// Keeps the elite and reinitializes the other genes, either from scratch or by perturbing the elite.
+static void restartPopulation(Species *species, rng32 *rng)
+{
+	const RestartPolicy *policy = &(species -> genMeth -> restartPolicy);
+	const GeneticMethods *genMeth = species -> genMeth;
+	const int elite_number = policy -> eliteNumber < 1 ? 1 : policy -> eliteNumber;
+
+	// Moving the elite to the front of the population, by partial selection sort:
+	for (int e = 0; e < elite_number && e < species -> populationSize; ++e)
+	{
+		int index_best = e;
+
+		for (int i = e + 1; i < species -> populationSize; ++i)
+		{
+			if (species -> fitnessArray[i] > species -> fitnessArray[index_best])
+				index_best = i;
+		}
+
+		void *gene = species -> population[e];
+		species -> population[e] = species -> population[index_best];
+		species -> population[index_best] = gene;
+
+		double fitness = species -> fitnessArray[e];
+		species -> fitnessArray[e] = species -> fitnessArray[index_best];
+		species -> fitnessArray[index_best] = fitness;
+	}
+
+	for (int i = elite_number; i < species -> populationSize; ++i)
+	{
+		if (policy -> perturbationNumber > 0)
+		{
+			genMeth -> copyGene(species -> context, species -> population[i], species -> population[i % elite_number]);
+
+			for (int m = 0; m < policy -> perturbationNumber; ++m)
+				genMeth -> mutation(species -> context, rng, species -> population[i], species -> state.epoch);
+		}
 
-		*epoch_last_update = epoch;
+		else if (genMeth -> initGene)
+			genMeth -> initGene(species -> context, rng, species -> population[i]);
 
-		*index_worst = -1; // index_worst will need to be found again.
+		else
+		{
+			genMeth -> destroyGene(species -> context, species -> population[i]);
+			species -> population[i] = genMeth -> createGene(species -> context, rng);
+		}
 	}
+
+	updatePopulationFitness(species, species -> state.epoch);
+
+	species -> state.epochLastImprovement = species -> state.epoch;
+	++(species -> state.restartNumber);
 }
 
 
 // Finds the current gene of best fitness, save it in 'species -> geneBuffer', and returns its fitness (unshifted).
 static double getBestResult(const Species *species)
 {
-	// Finding the gene of higher fitness:
-	int index_best = indexBest(species);
+	const int index_best = species -> state.indexBest;
 
 	// Saving the best found gene:
 	species -> genMeth -> copyGene(species -> context, species -> geneBuffer, species -> population[index_best]);
@@ -197,26 +307,28 @@ Species* createSpecies(const GeneticMethods *genMeth, const void *context, int p
 
 	Species *species = (Species*) calloc(1, sizeof(Species));
 
-	rng32 rng; // 32-bit RNG.
-	uint64_t seed = GL_DETERMINISTIC ? GL_DEFAULT_SEED : create_seed(species);
-	rng32_init(&rng, seed, 0);
-
 	*(int*) &(species -> populationSize) = population_size;
 	species -> population = (void**) calloc(population_size, sizeof(void*));
 	species -> fitnessArray = (double*) calloc(population_size, sizeof(double));
-	species -> geneBuffer = genMeth -> createGene(context, &rng);
+	species -> rng = calloc(1, sizeof(rng32)); // 32-bit RNG.
 	species -> genMeth = genMeth;
 	species -> context = context;
+	species -> targetFitness = INFINITY;
 
-	if (!(species -> population) || !(species -> fitnessArray)) {
+	if (!(species -> population) || !(species -> fitnessArray) || !(species -> rng)) {
 		printf("\nNot enough memory to create a new species.\n");
 		destroySpecies(&species);
 		return NULL;
 	}
 
+	uint64_t seed = GL_DETERMINISTIC ? GL_DEFAULT_SEED : create_seed(species);
+	rng32_init(species -> rng, seed, 0);
+
+	species -> geneBuffer = genMeth -> createGene(context, species -> rng);
+
 	// Initializing the population:
 	for (int i = 0; i < population_size; ++i) {
-		species -> population[i] = genMeth -> createGene(context, &rng);
+		species -> population[i] = genMeth -> createGene(context, species -> rng);
 	}
 
 	updatePopulationFitness(species, 0);
@@ -225,6 +337,28 @@ Species* createSpecies(const GeneticMethods *genMeth, const void *context, int p
 }
 
 
+// Replaces the first genes of the population by copies of the given ones, e.g to warm start the search from known
+// solutions, and evaluates the population again. Genes beyond the population size are ignored. Returns 0 on failure.
+int seedSpecies(Species *species, void **genes, int genes_number)
+{
+	if (!species || !species -> genMeth || (!genes && genes_number > 0) || genes_number < 0) {
+		printf("\nInvalid argument in 'seedSpecies()'.\n\n");
+		return 0;
+	}
+
+	if (genes_number > species -> populationSize)
+		genes_number = species -> populationSize;
+
+	for (int i = 0; i < genes_number; ++i) {
+		species -> genMeth -> copyGene(species -> context, species -> population[i], genes[i]);
+	}
+
+	updatePopulationFitness(species, species -> state.epoch);
+
+	return 1;
+}
+
+
 // Freeing the given species, passed by address.
 void destroySpecies(Species **species_address)
 {
@@ -253,6 +387,7 @@ void destroySpecies(Species **species_address)
 		genMeth -> destroyGene(context, (*species_address) -> geneBuffer);
 	}
 
+	free((*species_address) -> rng);
 	free((*species_address) -> fitnessArray);
 	free((*species_address) -> population);
 	free(*species_address);
@@ -260,6 +395,45 @@ void destroySpecies(Species **species_address)
 }
 
 
+// Reinitializes the population and the search state of the given species, for the given context. Genes are reused
+// when 'genMeth -> initGene' is given, thus they must be large enough for the new context. The target fitness is
+// reset as well. Returns 0 on failure.
+int resetSpecies(Species *species, const void *context)
+{
+	if (!species || !species -> genMeth || !species -> population) {
+		printf("\nInvalid argument in 'resetSpecies()'.\n\n");
+		return 0;
+	}
+
+	const GeneticMethods *genMeth = species -> genMeth;
+
+	for (int i = 0; i < species -> populationSize; ++i)
+	{
+		if (genMeth -> initGene)
+			genMeth -> initGene(context, species -> rng, species -> population[i]);
+		else
+		{
+			genMeth -> destroyGene(species -> context, species -> population[i]);
+			species -> population[i] = genMeth -> createGene(context, species -> rng);
+		}
+	}
+
+	if (!genMeth -> initGene)
+	{
+		genMeth -> destroyGene(species -> context, species -> geneBuffer);
+		species -> geneBuffer = genMeth -> createGene(context, species -> rng);
+	}
+
+	species -> context = context;
+	species -> state = (SearchState) {0};
+	species -> targetFitness = INFINITY;
+
+	updatePopulationFitness(species, 0);
+
+	return 1;
+}
+
+
 // Genetic search. 'Good' genes are beeing seeked by evolving from a population, and the best
 // found gene is saved in 'species -> geneBuffer' and its (unshifted) fitness is returned.
 double geneticSearch(Species *species, long epoch_number)
@@ -271,21 +445,67 @@ double geneticSearch(Species *species, long epoch_number)
 		return 0.;
 	}
 
+	// Each genetic search starts anew, as far as the epochs are concerned:
+	species -> state.epoch = 0;
+	species -> state.epochLastUpdate = 0;
+	species -> state.epochLastImprovement = 0;
+
+	const long restart_number = species -> state.restartNumber;
+
+	geneticStep(species, epoch_number);
+
+	////////////////////////////////////////////////////////////////////////////////
+	// Returning the best result:
+
+	double best_fitness = getBestResult(species);
+	double elapsed_time = get_time() - time_start;
+	double epoch_ratio = (double) species -> state.epochLastUpdate / epoch_number;
+
+	if (GL_VERBOSE_MODE) {
+		printf("\nGenetic search:\n -> Time elapsed: %.3f s, epoch ratio: %.3f, best found fitness: %.6f",
+			elapsed_time, epoch_ratio, best_fitness);
+
+		if (species -> state.restartNumber > restart_number)
+			printf(", restarts: %ld", species -> state.restartNumber - restart_number);
+
+		if (targetReached(species))
+			printf(", target reached at epoch %ld", species -> state.epoch);
+
+		printf("\n\n");
+	}
+
+	return best_fitness;
+}
+
+
+// Resumable genetic search: runs 'epoch_number' more epochs, carrying on from the state left by the previous
+// call, without reseeding nor printing anything. Cheap enough to time-slice many species in a single thread.
+// Returns the (unshifted) best fitness found so far. The best gene is not copied in 'species -> geneBuffer'.
+double geneticStep(Species *species, long epoch_number)
+{
+	if (!species || !species -> genMeth || species -> populationSize < 1 || epoch_number < 0) {
+		printf("\nInvalid argument in 'geneticStep()'.\n\n");
+		return 0.;
+	}
+
 	const GeneticMethods *genMeth = species -> genMeth;
 	const void *context = species -> context;
+	SearchState *state = &(species -> state);
 
-	rng32 rng; // 32-bit RNG.
-	uint64_t seed = GL_DETERMINISTIC ? GL_DEFAULT_SEED : create_seed(species);
-	rng32_init(&rng, seed, 0);
+	rng32 rng = *(rng32*) species -> rng; // local copy, for speed.
+
+	const RestartPolicy *policy = &(genMeth -> restartPolicy);
+	const int restart_enabled = policy -> stagnationEpochs > 0 || policy -> minRelativeDeviation > 0.;
 
 	////////////////////////////////////////////////////////////////////////////////
-	// Starting the evolution process:
+	// Carrying on the evolution process:
 
-	long epoch_last_update = 0;
-	int index_worst = -1;
+	const long epoch_end = state -> epoch + epoch_number;
 
-	for (long epoch = 0; epoch < epoch_number; ++epoch)
+	for (; state -> epoch < epoch_end && !targetReached(species); ++(state -> epoch))
 	{
+		const long epoch = state -> epoch;
+
 		// Checking if the fitness values have to be updated:
 		if (genMeth -> setFitnessUpdateStatus && genMeth -> setFitnessUpdateStatus(context, epoch)) {
 			updatePopulationFitness(species, epoch);
@@ -311,21 +531,55 @@ double geneticSearch(Species *species, long epoch_number)
 		double new_fitness = species -> fitnessShift + genMeth -> fitness(context, species -> geneBuffer, epoch);
 
 		// Replacing the worst gene by a new one if the latter is better, and if so updates the sum of fitnesses
-		// and 'index_worst'. Also, assures that no negative fitness can be added when using SEL_PROPORTIONATE.
-		replaceWorst(species, &index_worst, new_fitness, epoch, &epoch_last_update);
+		// and the search state. Also, assures that no negative fitness can be added when using SEL_PROPORTIONATE.
+		replaceWorst(species, new_fitness);
+
+		// Partially reinitializing the population if the search stagnates:
+		if (restart_enabled && isStagnating(species)) {
+			restartPopulation(species, &rng);
+		}
 	}
 
-	////////////////////////////////////////////////////////////////////////////////
-	// Returning the best result:
+	*(rng32*) species -> rng = rng;
 
-	double best_fitness = getBestResult(species);
-	double elapsed_time = get_time() - time_start;
-	double epoch_ratio = (double) epoch_last_update / epoch_number;
+	return species -> fitnessArray[state -> indexBest] - species -> fitnessShift; // unshifted.
+}
 
-	if (GL_VERBOSE_MODE) {
-		printf("\nGenetic search:\n -> Time elapsed: %.3f s, epoch ratio: %.3f, best found fitness: %.6f\n\n",
-			elapsed_time, epoch_ratio, best_fitness);
+
+// Offers an external gene (e.g a migrant from another species) to the population: it is copied and replaces
+// the worst gene, if it is better. Returns 1 if it has been accepted, 0 otherwise.
+int immigrateGene(Species *species, const void *gene)
+{
+	if (!species || !species -> genMeth || !gene) {
+		printf("\nInvalid argument in 'immigrateGene()'.\n\n");
+		return 0;
 	}
 
-	return best_fitness;
+	const GeneticMethods *genMeth = species -> genMeth;
+	const long accepted_number = species -> state.acceptedNumber;
+
+	genMeth -> copyGene(species -> context, species -> geneBuffer, gene);
+
+	double new_fitness = species -> fitnessShift + genMeth -> fitness(species -> context, species -> geneBuffer,
+		species -> state.epoch);
+
+	replaceWorst(species, new_fitness);
+
+	return species -> state.acceptedNumber > accepted_number;
+}
+
+
+// Returns the current best gene of the population, without copying it, and saves its (unshifted)
+// fitness in 'fitness' if the latter isn't NULL. The gene stays owned by the species.
+const void* getBestGene(const Species *species, double *fitness)
+{
+	if (!species || !species -> population)
+		return NULL;
+
+	const int index_best = species -> state.indexBest;
+
+	if (fitness)
+		*fitness = species -> fitnessArray[index_best] - species -> fitnessShift;
+
+	return species -> population[index_best];
 }
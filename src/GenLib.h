@@ -12,7 +12,7 @@
 extern "C" {
 #endif
 
-#define GENLIB_VERSION 1.7
+#define GENLIB_VERSION 1.8
 
 ////////////////////////////////////////////////////////////////////////////////
 // Settings:
@@ -30,6 +30,12 @@ extern "C" {
 // found, and the best found fitness value.
 #define GL_VERBOSE_MODE 1
 
+
+// When an offspring replaces the worst gene, swap their pointers instead of deep copying the offspring with
+// copyGene(). Accepting an offspring then costs O(1), regardless of the gene size. Note that as a consequence,
+// the address of 'species -> geneBuffer' may change during a genetic search.
+#define GL_OWNERSHIP_TRANSFER 1
+
 // For speed benchmarks:
 #define GL_DETERMINISTIC 0
 #define GL_DEFAULT_SEED 123456 // used when GL_DETERMINISTIC = 1
@@ -49,6 +55,25 @@ extern "C" {
 typedef enum {SEL_PROPORTIONATE, SEL_UNIFORM} SelectionMode;
 
 
+// Partial reinitialization of the population when the search stagnates. Every field left to 0 disables it.
+typedef struct
+{
+	// Restarting after this number of epochs without any improvement of the best fitness.
+	long stagnationEpochs;
+
+	// Restarting when the standard deviation of the fitness values, relative to their mean, gets below this.
+	// Checked every 'populationSize' epochs.
+	double minRelativeDeviation;
+
+	// Number of best genes kept during a restart, at least 1 so that the best found gene is never lost.
+	int eliteNumber;
+
+	// When > 0, the other genes are copies of the elite, mutated this number of times. When 0,
+	// they are created again, with 'initGene' if given, else with 'createGene'.
+	int perturbationNumber;
+} RestartPolicy;
+
+
 // N.B: genes, and context can be numerical types, structs, NULL, or dynamically allocated arrays.
 typedef struct
 {
@@ -56,6 +81,9 @@ typedef struct
 	// Choice of selection mechanism.
 	SelectionMode selectionMode;
 
+	// Optional, restarting the search on stagnation.
+	RestartPolicy restartPolicy;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// Gene basic functions:
 
@@ -68,6 +96,10 @@ typedef struct
 	// Freeing a gene.
 	void (*destroyGene)(const void *context, void *gene);
 
+	// Reinitializes in place an already allocated gene, as createGene() would have. Used by resetSpecies()
+	// to reuse the memory of a species. Can be left to NULL, genes then being destroyed and created again.
+	void (*initGene)(const void *context, void *rng, void *gene);
+
 	////////////////////////////////////////////////////////////////////////////////
 	// Genetic functions - problem dependant:
 
@@ -95,6 +127,19 @@ typedef struct
 ////////////////////////////////////////////////////////////////////////////////
 // Genetic public function:
 
+// State of the search, persisting between successive calls to geneticStep():
+typedef struct
+{
+	long epoch; // number of epochs done so far.
+	long epochLastUpdate; // last epoch at which an offspring has been accepted.
+	long acceptedNumber; // number of accepted offsprings so far.
+	long epochLastImprovement; // last epoch at which the best fitness has been improved.
+	long restartNumber; // number of restarts so far, see RestartPolicy.
+	int indexBest; // index of the gene of greater fitness.
+	int indexWorst; // index of the gene of lower fitness, -1 if it needs to be found again.
+} SearchState;
+
+
 typedef struct
 {
 	const int populationSize;
@@ -103,6 +148,10 @@ typedef struct
 	void *geneBuffer;
 	double sumFitnesses;
 	double fitnessShift;
+	double targetFitness; // (unshifted) the search stops once a gene this fit is found. +INFINITY by default.
+
+	SearchState state;
+	void *rng; // internal RNG, used by the genetic operators.
 
 	// Saved here for convenience:
 	const GeneticMethods *genMeth;
@@ -114,15 +163,42 @@ typedef struct
 Species* createSpecies(const GeneticMethods *genMeth, const void *context, int population_size);
 
 
+// Replaces the first genes of the population by copies of the given ones, e.g to warm start the search from known
+// solutions, and evaluates the population again. Genes beyond the population size are ignored. Returns 0 on failure.
+int seedSpecies(Species *species, void **genes, int genes_number);
+
+
 // Freeing the given species, passed by address.
 void destroySpecies(Species **species_address);
 
 
+// Reinitializes the population and the search state of the given species, for the given context. Genes are reused
+// when 'genMeth -> initGene' is given, thus they must be large enough for the new context. The target fitness is
+// reset as well. Returns 0 on failure.
+int resetSpecies(Species *species, const void *context);
+
+
 // Genetic search. 'Good' genes are beeing seeked by evolving from a population, and the best
 // found gene is saved in 'species -> geneBuffer' and its (unshifted) fitness is returned.
 double geneticSearch(Species *species, long epoch_number);
 
 
+// Resumable genetic search: runs 'epoch_number' more epochs, carrying on from the state left by the previous
+// call, without reseeding nor printing anything. Cheap enough to time-slice many species in a single thread.
+// Returns the (unshifted) best fitness found so far. The best gene is not copied in 'species -> geneBuffer'.
+double geneticStep(Species *species, long epoch_number);
+
+
+// Offers an external gene (e.g a migrant from another species) to the population: it is copied and replaces
+// the worst gene, if it is better. Returns 1 if it has been accepted, 0 otherwise.
+int immigrateGene(Species *species, const void *gene);
+
+
+// Returns the current best gene of the population, without copying it, and saves its (unshifted)
+// fitness in 'fitness' if the latter isn't NULL. The gene stays owned by the species.
+const void* getBestGene(const Species *species, double *fitness);
+
+
 #if __cplusplus
 }
 #endif
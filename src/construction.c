@@ -0,0 +1,724 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "construction.h"
+#include "sales_gen.h" // for mirror()
+#include "rng32.h"
+
+
+// Cities not picked yet, ordered along the space-filling curve, or by index for EXPLICIT maps. Picked ranks are skipped
+// by following links towards the next rank left on each side, compressed as they are followed.
+typedef struct
+{
+	int *order; // cities, by rank.
+	int *rank; // rank of each city.
+	int *right; // rank itself if left, else a rank closer to the next one left. 'citiesNumber' if none.
+	int *left; // same on the other side, shifted by one: position 0 means none.
+	int citiesNumber;
+	int leftNumber;
+	int window; // cities looked at on each side by nearestLeft().
+} CurveSet;
+
+
+// Sub-tours and fragments are tracked with a union-find structure:
+static int findRoot(int *parents, int city)
+{
+	int root = city;
+
+	while (parents[root] != root)
+		root = parents[root];
+
+	while (parents[city] != root)
+	{
+		int next = parents[city];
+		parents[city] = root;
+		city = next;
+	}
+
+	return root;
+}
+
+
+static void freeCurveSet(CurveSet *set)
+{
+	free(set -> order);
+	free(set -> rank);
+	free(set -> right);
+	free(set -> left);
+}
+
+
+// Holds all the cities at first. Returns 0 on memory error.
+static int initCurveSet(CurveSet *set, const Map *map, void *rng)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	set -> order = (int*) malloc(cities_number * sizeof(int));
+	set -> rank = (int*) malloc(cities_number * sizeof(int));
+	set -> right = (int*) malloc((cities_number + 1) * sizeof(int));
+	set -> left = (int*) malloc((cities_number + 1) * sizeof(int));
+	set -> citiesNumber = cities_number;
+	set -> leftNumber = cities_number;
+	set -> window = CURVE_WINDOW;
+
+	if (!set -> order || !set -> rank || !set -> right || !set -> left)
+	{
+		freeCurveSet(set);
+		return 0;
+	}
+
+	if (!spaceFillingOrder(map, rng, set -> order))
+	{
+		for (int i = 0; i < cities_number; ++i)
+			set -> order[i] = i;
+
+		set -> window = cities_number; // no locality, every city is looked at.
+	}
+
+	for (int i = 0; i <= cities_number; ++i)
+	{
+		set -> right[i] = i;
+		set -> left[i] = i;
+	}
+
+	for (int i = 0; i < cities_number; ++i)
+		set -> rank[set -> order[i]] = i;
+
+	return 1;
+}
+
+
+static inline int isLeft(const CurveSet *set, int city)
+{
+	const int rank = set -> rank[city];
+
+	return set -> right[rank] == rank;
+}
+
+
+static inline void removeCity(CurveSet *set, int city)
+{
+	const int rank = set -> rank[city];
+
+	if (set -> right[rank] != rank)
+		return;
+
+	set -> right[rank] = rank + 1;
+	set -> left[rank + 1] = rank;
+	--(set -> leftNumber);
+}
+
+
+// Next rank left from the given one included, going right, 'citiesNumber' if none:
+static inline int rightRank(CurveSet *set, int rank)
+{
+	return findRoot(set -> right, rank);
+}
+
+
+// Same going left, -1 if none:
+static inline int leftRank(CurveSet *set, int rank)
+{
+	return findRoot(set -> left, rank + 1) - 1;
+}
+
+
+// First city left, along the curve:
+static inline int firstLeft(CurveSet *set)
+{
+	return set -> order[rightRank(set, 0)];
+}
+
+
+// Nearest city left among the 'window' ones on each side of the given city along the curve, -1 if none is left:
+static int nearestLeft(CurveSet *set, const Map *map, int city)
+{
+	const int rank = set -> rank[city];
+
+	int nearest = -1;
+	num_dist nearest_dist = NUM_DIST_MAX;
+
+	int r = rank;
+
+	for (int i = 0; i < set -> window && (r = rightRank(set, r + 1)) < set -> citiesNumber; ++i)
+	{
+		const num_dist dist = getDistance(map, city, set -> order[r]);
+
+		if (nearest < 0 || dist < nearest_dist)
+		{
+			nearest = set -> order[r];
+			nearest_dist = dist;
+		}
+	}
+
+	r = rank;
+
+	for (int i = 0; i < set -> window && (r = leftRank(set, r - 1)) >= 0; ++i)
+	{
+		const num_dist dist = getDistance(map, city, set -> order[r]);
+
+		if (nearest < 0 || dist < nearest_dist)
+		{
+			nearest = set -> order[r];
+			nearest_dist = dist;
+		}
+	}
+
+	return nearest;
+}
+
+
+// Index along a Hilbert curve of the cell (x, y), in a grid of 2^HILBERT_ORDER cells per side:
+static uint64_t hilbertIndex(uint32_t x, uint32_t y)
+{
+	const uint32_t side = 1u << HILBERT_ORDER;
+
+	uint64_t index = 0;
+
+	for (uint32_t s = side / 2; s > 0; s /= 2)
+	{
+		const uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+
+		index += (uint64_t) s * s * ((3 * rx) ^ ry);
+
+		// Rotating the quadrant, so that the curve is continuous:
+		if (ry == 0)
+		{
+			if (rx == 1)
+			{
+				x = side - 1 - x;
+				y = side - 1 - y;
+			}
+
+			uint32_t temp = x;
+			x = y;
+			y = temp;
+		}
+	}
+
+	return index;
+}
+
+
+static int compareKeys(const void *a, const void *b)
+{
+	const uint64_t key_a = *(const uint64_t*) a, key_b = *(const uint64_t*) b;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+
+// Order of the cities along a Hilbert curve over the map, randomly shifted and mirrored if 'rng' isn't NULL.
+// Cities close along the curve are close on the map. Returns 0 for EXPLICIT maps, which have no locations,
+// or on memory error.
+int spaceFillingOrder(const Map *map, void *rng, int *order)
+{
+	if (!map || !order)
+	{
+		printf("\nInvalid argument in 'spaceFillingOrder()'.\n\n");
+		return 0;
+	}
+
+	if (map -> WeightType == EXPLICIT)
+		return 0;
+
+	const int cities_number = map -> CitiesNumber;
+
+	uint64_t *keys = (uint64_t*) malloc(cities_number * sizeof(uint64_t));
+
+	if (!keys)
+		return 0;
+
+	const num_map *xs = map -> Locations[0], *ys = map -> Locations[1];
+
+	double min[2] = {xs[0], ys[0]}, max[2] = {xs[0], ys[0]};
+
+	for (int i = 1; i < cities_number; ++i)
+	{
+		min[0] = xs[i] < min[0] ? xs[i] : min[0];
+		max[0] = xs[i] > max[0] ? xs[i] : max[0];
+		min[1] = ys[i] < min[1] ? ys[i] : min[1];
+		max[1] = ys[i] > max[1] ? ys[i] : max[1];
+	}
+
+	double span = max[0] - min[0] > max[1] - min[1] ? max[0] - min[0] : max[1] - min[1];
+
+	if (span <= 0.)
+		span = 1.;
+
+	// Randomly shifted inside a grid twice larger, and mirrored:
+	double scale = ((1u << HILBERT_ORDER) - 1) / span, shift[2] = {0., 0.};
+	int swap_axes = 0, flip_x = 0, flip_y = 0;
+
+	if (rng)
+	{
+		scale /= 2.;
+		shift[0] = rng32_nextFloat(rng) * (1u << (HILBERT_ORDER - 1));
+		shift[1] = rng32_nextFloat(rng) * (1u << (HILBERT_ORDER - 1));
+
+		const uint32_t bits = rng32_nextInt(rng);
+		swap_axes = bits & 1;
+		flip_x = (bits >> 1) & 1;
+		flip_y = (bits >> 2) & 1;
+	}
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const double x = flip_x ? max[0] - xs[i] : xs[i] - min[0];
+		const double y = flip_y ? max[1] - ys[i] : ys[i] - min[1];
+
+		const uint32_t cell_x = (uint32_t) (x * scale + shift[0]), cell_y = (uint32_t) (y * scale + shift[1]);
+
+		keys[i] = (swap_axes ? hilbertIndex(cell_y, cell_x) : hilbertIndex(cell_x, cell_y)) << 32 | (uint32_t) i;
+	}
+
+	qsort(keys, cities_number, sizeof(uint64_t), compareKeys);
+
+	for (int i = 0; i < cities_number; ++i)
+		order[i] = (int) (keys[i] & 0xFFFFFFFFu);
+
+	free(keys);
+
+	return 1;
+}
+
+
+// Nearest neighbor heuristic, starting from a random city. The nearest city left is looked for among the candidates,
+// then along the curve, and is skipped for the second one with probability NN_SKIP_PROBABILITY.
+static void nearestNeighborOrder(const Map *map, void *rng, CurveSet *set, int *order)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	int city = rng ? rng32_nextInt(rng) % cities_number : 0;
+
+	removeCity(set, city);
+	order[0] = city;
+
+	for (int i = 1; i < cities_number; ++i)
+	{
+		const int *candidates = getCandidates(map, city);
+
+		int next = -1;
+
+		for (int k = 0; k < map -> CandidatesNumber; ++k)
+		{
+			if (!isLeft(set, candidates[k]))
+				continue;
+
+			const int skipped = next < 0 && rng && rng32_nextFloat(rng) < NN_SKIP_PROBABILITY;
+
+			next = candidates[k];
+
+			if (!skipped)
+				break;
+		}
+
+		if (next < 0)
+			next = nearestLeft(set, map, city);
+
+		removeCity(set, next);
+		order[i] = city = next;
+	}
+}
+
+
+typedef struct
+{
+	float key;
+	int a;
+	int b;
+} Edge;
+
+
+static int compareEdges(const void *a, const void *b)
+{
+	const float key_a = ((const Edge*) a) -> key, key_b = ((const Edge*) b) -> key;
+
+	return (key_a > key_b) - (key_a < key_b);
+}
+
+
+// Candidate edges, each one once, sorted by length, up to a relative noise of CONSTRUCTION_NOISE if 'rng' isn't NULL.
+// Returns NULL on memory error.
+static Edge* sortedEdges(const Map *map, void *rng, int *edges_number)
+{
+	const int candidates_number = map -> CandidatesNumber;
+
+	Edge *edges = (Edge*) malloc((size_t) map -> CitiesNumber * candidates_number * sizeof(Edge));
+
+	if (!edges)
+		return NULL;
+
+	*edges_number = 0;
+
+	for (int a = 0; a < map -> CitiesNumber; ++a)
+	{
+		const int *candidates = getCandidates(map, a);
+		const num_dist *distances = getCandidatesDistances(map, a);
+
+		for (int k = 0; k < candidates_number; ++k)
+		{
+			const int b = candidates[k];
+
+			// Skipped if also found from 'b':
+			if (b < a)
+			{
+				const int *candidates_b = getCandidates(map, b);
+				int found = 0;
+
+				for (int l = 0; l < candidates_number && !found; ++l)
+					found = candidates_b[l] == a;
+
+				if (found)
+					continue;
+			}
+
+			float key = distances[k];
+
+			if (rng)
+				key *= 1.f + CONSTRUCTION_NOISE * rng32_nextFloat(rng);
+
+			edges[(*edges_number)++] = (Edge) {key, a, b};
+		}
+	}
+
+	qsort(edges, *edges_number, sizeof(Edge), compareEdges);
+
+	return edges;
+}
+
+
+// Greedy edge heuristic: the shortest candidate edges are added as long as no city gets more than two of them,
+// and no cycle is closed. The resulting fragments are then joined by a nearest neighbor walk over their endpoints.
+// Returns 0 on memory error.
+static int greedyEdgeOrder(const Map *map, void *rng, CurveSet *set, int *order)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	int edges_number;
+	Edge *edges = sortedEdges(map, rng, &edges_number);
+	int *links = (int*) malloc(2 * cities_number * sizeof(int));
+	int *parents = (int*) malloc(cities_number * sizeof(int));
+
+	if (!edges || !links || !parents)
+	{
+		free(edges);
+		free(links);
+		free(parents);
+		return 0;
+	}
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		links[2 * city] = links[2 * city + 1] = -1;
+		parents[city] = city;
+	}
+
+	for (int e = 0; e < edges_number; ++e)
+	{
+		const int a = edges[e].a, b = edges[e].b;
+
+		if (links[2 * a + 1] >= 0 || links[2 * b + 1] >= 0)
+			continue;
+
+		const int root_a = findRoot(parents, a), root_b = findRoot(parents, b);
+
+		if (root_a == root_b)
+			continue;
+
+		parents[root_a] = root_b;
+		links[2 * a + (links[2 * a] >= 0)] = b;
+		links[2 * b + (links[2 * b] >= 0)] = a;
+	}
+
+	// Only the endpoints of the fragments are left in the set:
+	for (int city = 0; city < cities_number; ++city)
+	{
+		if (links[2 * city + 1] >= 0)
+			removeCity(set, city);
+	}
+
+	// Starting from a random endpoint:
+	const int rank = rng ? rightRank(set, rng32_nextInt(rng) % cities_number) : cities_number;
+	int city = rank < cities_number ? set -> order[rank] : firstLeft(set);
+
+	for (int i = 0; i < cities_number; )
+	{
+		// Walking along the fragment, from one endpoint to the other:
+		removeCity(set, city);
+
+		for (int prev = -1; city >= 0; )
+		{
+			order[i++] = city;
+
+			const int next = links[2 * city] != prev ? links[2 * city] : links[2 * city + 1];
+
+			prev = city;
+			city = next;
+		}
+
+		city = order[i - 1];
+		removeCity(set, city);
+
+		if (i == cities_number)
+			break;
+
+		// Nearest endpoint of another fragment:
+		const int *candidates = getCandidates(map, city);
+		int next = -1;
+
+		for (int k = 0; k < map -> CandidatesNumber && next < 0; ++k)
+		{
+			if (isLeft(set, candidates[k]))
+				next = candidates[k];
+		}
+
+		city = next >= 0 ? next : nearestLeft(set, map, city);
+	}
+
+	free(edges);
+	free(links);
+	free(parents);
+
+	return 1;
+}
+
+
+// Christofides-like heuristic: a spanning tree is built from the candidate edges (Kruskal), those of odd degree are
+// matched greedily, and the resulting Eulerian circuit is shortcut. The minimum perfect matching is replaced by a
+// greedy one, so that no 1.5 factor is guaranteed. Returns 0 on memory error.
+static int christofidesOrder(const Map *map, void *rng, CurveSet *set, int *order)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int max_edges = cities_number - 1 + cities_number / 2;
+
+	int edges_number;
+	Edge *edges = sortedEdges(map, rng, &edges_number);
+	int *parents = (int*) malloc(cities_number * sizeof(int)); // then the next edge to follow from each city.
+	int *degrees = (int*) calloc(cities_number + 1, sizeof(int)); // then the offsets of the adjacency lists.
+	int *ends = (int*) malloc(2 * max_edges * sizeof(int)); // endpoints of the edges of the multigraph.
+	int *adjacency = (int*) malloc(2 * max_edges * sizeof(int));
+	int *stack = (int*) malloc((max_edges + 1) * sizeof(int));
+	char *used = (char*) calloc(max_edges, sizeof(char));
+	char *visited = (char*) calloc(cities_number, sizeof(char));
+
+	if (!edges || !parents || !degrees || !ends || !adjacency || !stack || !used || !visited)
+	{
+		free(edges);
+		free(parents);
+		free(degrees);
+		free(ends);
+		free(adjacency);
+		free(stack);
+		free(used);
+		free(visited);
+		return 0;
+	}
+
+	int graph_edges = 0;
+
+	// Spanning tree, the components left being linked along the curve:
+
+	for (int city = 0; city < cities_number; ++city)
+		parents[city] = city;
+
+	for (int e = 0; e < edges_number && graph_edges < cities_number - 1; ++e)
+	{
+		const int root_a = findRoot(parents, edges[e].a), root_b = findRoot(parents, edges[e].b);
+
+		if (root_a == root_b)
+			continue;
+
+		parents[root_a] = root_b;
+		ends[2 * graph_edges] = edges[e].a;
+		ends[2 * graph_edges + 1] = edges[e].b;
+		++graph_edges;
+	}
+
+	for (int r = 1; r < cities_number && graph_edges < cities_number - 1; ++r)
+	{
+		const int a = set -> order[r - 1], b = set -> order[r];
+		const int root_a = findRoot(parents, a), root_b = findRoot(parents, b);
+
+		if (root_a == root_b)
+			continue;
+
+		parents[root_a] = root_b;
+		ends[2 * graph_edges] = a;
+		ends[2 * graph_edges + 1] = b;
+		++graph_edges;
+	}
+
+	for (int e = 0; e < 2 * graph_edges; ++e)
+		++degrees[ends[e]];
+
+	// Greedy matching of the cities of odd degree, along candidate edges first, then along the curve:
+
+	for (int e = 0; e < edges_number; ++e)
+	{
+		const int a = edges[e].a, b = edges[e].b;
+
+		if (degrees[a] % 2 == 0 || degrees[b] % 2 == 0)
+			continue;
+
+		ends[2 * graph_edges] = a;
+		ends[2 * graph_edges + 1] = b;
+		++graph_edges;
+		++degrees[a];
+		++degrees[b];
+	}
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		if (degrees[city] % 2 == 0)
+			removeCity(set, city);
+	}
+
+	while (set -> leftNumber > 0)
+	{
+		const int a = firstLeft(set);
+		removeCity(set, a);
+
+		const int b = nearestLeft(set, map, a);
+		removeCity(set, b);
+
+		ends[2 * graph_edges] = a;
+		ends[2 * graph_edges + 1] = b;
+		++graph_edges;
+		++degrees[a];
+		++degrees[b];
+	}
+
+	// Adjacency lists, 'degrees' becoming their offsets:
+
+	for (int city = 0, offset = 0; city <= cities_number; ++city)
+	{
+		const int degree = degrees[city];
+		degrees[city] = offset;
+		offset += degree;
+	}
+
+	int *next_edges = parents;
+	memcpy(next_edges, degrees, cities_number * sizeof(int));
+
+	for (int e = 0; e < graph_edges; ++e)
+	{
+		adjacency[next_edges[ends[2 * e]]++] = e;
+		adjacency[next_edges[ends[2 * e + 1]]++] = e;
+	}
+
+	memcpy(next_edges, degrees, cities_number * sizeof(int));
+
+	// Eulerian circuit (Hierholzer), shortcut by keeping the first visit of each city:
+
+	int stack_size = 1, visited_number = 0;
+	stack[0] = rng ? rng32_nextInt(rng) % cities_number : 0;
+
+	while (stack_size > 0)
+	{
+		const int city = stack[stack_size - 1];
+
+		while (next_edges[city] < degrees[city + 1] && used[adjacency[next_edges[city]]])
+			++next_edges[city];
+
+		if (next_edges[city] == degrees[city + 1])
+		{
+			--stack_size;
+
+			if (!visited[city])
+			{
+				visited[city] = 1;
+				order[visited_number++] = city;
+			}
+
+			continue;
+		}
+
+		const int e = adjacency[next_edges[city]];
+		used[e] = 1;
+		stack[stack_size++] = ends[2 * e] == city ? ends[2 * e + 1] : ends[2 * e];
+	}
+
+	free(edges);
+	free(parents);
+	free(degrees);
+	free(ends);
+	free(adjacency);
+	free(stack);
+	free(used);
+	free(visited);
+
+	return 1;
+}
+
+
+// Builds a path with the construction heuristic of the given InitMode, among NEAREST_NEIGHBOR_INIT, GREEDY_EDGE_INIT,
+// SPACE_FILLING_CURVE_INIT (nearest neighbor for EXPLICIT maps) and CHRISTOFIDES_INIT. Returns 0 for other modes,
+// or on memory error.
+int constructPath(const Map *map, void *rng, int *path, InitMode initMode)
+{
+	if (initMode != NEAREST_NEIGHBOR_INIT && initMode != GREEDY_EDGE_INIT && initMode != SPACE_FILLING_CURVE_INIT
+		&& initMode != CHRISTOFIDES_INIT)
+		return 0;
+
+	if (initMode == SPACE_FILLING_CURVE_INIT && map -> WeightType == EXPLICIT) // no locations to follow.
+		initMode = NEAREST_NEIGHBOR_INIT;
+
+	const int cities_number = map -> CitiesNumber;
+
+	// Temporary candidate lists, if the map has none:
+	Map local_map = *map;
+
+	if (map -> CandidatesNumber == 0 && initMode != SPACE_FILLING_CURVE_INIT)
+	{
+		const int candidates_number = CONSTRUCTION_CANDIDATES < cities_number ? CONSTRUCTION_CANDIDATES :
+			cities_number - 1;
+
+		local_map.Mapping = NULL;
+
+		if (candidates_number < 1 || !initCandidates(&local_map, candidates_number))
+			return 0;
+	}
+
+	int *order = (int*) malloc(cities_number * sizeof(int));
+	CurveSet set = {0};
+
+	int success = order && initCurveSet(&set, &local_map, rng);
+
+	if (success)
+	{
+		if (initMode == NEAREST_NEIGHBOR_INIT)
+			nearestNeighborOrder(&local_map, rng, &set, order);
+
+		else if (initMode == GREEDY_EDGE_INIT)
+			success = greedyEdgeOrder(&local_map, rng, &set, order);
+
+		else if (initMode == CHRISTOFIDES_INIT)
+			success = christofidesOrder(&local_map, rng, &set, order);
+
+		else
+			memcpy(order, set.order, cities_number * sizeof(int));
+
+		freeCurveSet(&set);
+	}
+
+	if (success)
+	{
+		seedPath(path, order, cities_number);
+
+		// Preventing useless symmetric representation:
+		if (SYMMETRY_PREVENTION && path[1] > path[cities_number - 1])
+			mirror(path, 1, cities_number - 1);
+	}
+
+	if (local_map.Candidates != map -> Candidates)
+	{
+		free(local_map.Candidates);
+		free(local_map.CandidatesDistances);
+	}
+
+	free(order);
+
+	return success;
+}
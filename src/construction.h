@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////
+// Construction heuristics, building short paths in O(n log n) from the candidate lists (see initCandidates()),
+// instead of starting searches from random ones. They are randomized by the given RNG, if not NULL, so that
+// populations stay diverse. Used by initPath() for the corresponding InitMode.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CONSTRUCTION_H
+#define CONSTRUCTION_H
+
+
+#include "salesman.h"
+
+
+#define HILBERT_ORDER 16 // the space-filling curve goes through a grid of 2^HILBERT_ORDER cells per side.
+
+#define CONSTRUCTION_CANDIDATES 8 // candidates built temporarily when the map has none.
+#define CONSTRUCTION_NOISE 0.1f // relative noise on the edge lengths sorted by the greedy constructions.
+#define NN_SKIP_PROBABILITY 0.1f // probability for the nearest neighbor to be skipped for the second nearest one.
+#define CURVE_WINDOW 8 // cities looked at on each side along the curve, when no candidate is left.
+
+
+// Order of the cities along a Hilbert curve over the map, randomly shifted and mirrored if 'rng' isn't NULL.
+// Cities close along the curve are close on the map. Returns 0 for EXPLICIT maps, which have no locations,
+// or on memory error.
+int spaceFillingOrder(const Map *map, void *rng, int *order);
+
+
+// Builds a path with the construction heuristic of the given InitMode, among NEAREST_NEIGHBOR_INIT, GREEDY_EDGE_INIT,
+// SPACE_FILLING_CURVE_INIT (nearest neighbor for EXPLICIT maps) and CHRISTOFIDES_INIT. Returns 0 for other modes,
+// or on memory error.
+int constructPath(const Map *map, void *rng, int *path, InitMode initMode);
+
+
+#endif
@@ -1,62 +1,597 @@
+#define _POSIX_C_SOURCE 200809L // for mmap() and fstat().
+
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h> // for isdigit()
+#include <string.h>
+#include <math.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "driver_TSPLIB.h"
 
 
-#define BUFFER_SIZE 100
+#define WORD_SIZE 64 // longer keywords and values are truncated.
 
 
-Map* getMapFromDataset(const char *filename, DistanceRounding distMode)
+// Explicit matrix formats. Column formats enumerate the same pairs as the transposed row formats:
+typedef enum {FULL_MATRIX, UPPER_ROW, UPPER_DIAG_ROW, LOWER_ROW, LOWER_DIAG_ROW} WeightFormat;
+
+
+// Cursor over the mapped file, which isn't null terminated:
+typedef struct
 {
-	FILE *file = fopen(filename, "r");
+	const char *current;
+	const char *end;
+} Reader;
 
-	if (!file)
+
+static inline int isDigit(char c)
+{
+	return (unsigned) (c - '0') < 10;
+}
+
+
+static inline int isWordChar(char c)
+{
+	return isDigit(c) || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '_' || c == '-' || c == '.';
+}
+
+
+// Skips spaces, and line breaks if 'lines' is set:
+static inline void skipBlanks(Reader *reader, int lines)
+{
+	while (reader -> current < reader -> end && (*reader -> current == ' ' || *reader -> current == '\t'
+		|| *reader -> current == '\r' || (lines && *reader -> current == '\n')))
+		++(reader -> current);
+}
+
+
+static inline void skipLine(Reader *reader)
+{
+	const char *line_end = memchr(reader -> current, '\n', reader -> end - reader -> current);
+
+	reader -> current = line_end ? line_end + 1 : reader -> end;
+}
+
+
+// Reads the next word of the line in 'word', empty if there is none.
+static void readWord(Reader *reader, char *word)
+{
+	skipBlanks(reader, 0);
+
+	int length = 0;
+
+	for (; reader -> current < reader -> end && isWordChar(*reader -> current); ++(reader -> current))
+	{
+		if (length < WORD_SIZE - 1)
+			word[length++] = *reader -> current;
+	}
+
+	word[length] = '\0';
+}
+
+
+// Reads the next number, skipping blanks and line breaks. Returns 0 if there is none, the reader being left before
+// the next word. Faster than strtod(), which would also need null terminated strings.
+static int readNumber(Reader *reader, double *value)
+{
+	static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+		1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22}; // exact doubles.
+
+	skipBlanks(reader, 1);
+
+	const char *c = reader -> current, *end = reader -> end;
+
+	int negative = 0;
+
+	if (c < end && (*c == '-' || *c == '+'))
+		negative = *c++ == '-';
+
+	double mantissa = 0.;
+	int digits_number = 0, exponent = 0;
+
+	for (; c < end && isDigit(*c); ++c, ++digits_number)
+		mantissa = 10. * mantissa + (*c - '0');
+
+	if (c < end && *c == '.')
+	{
+		for (++c; c < end && isDigit(*c); ++c, ++digits_number, --exponent)
+			mantissa = 10. * mantissa + (*c - '0');
+	}
+
+	if (digits_number == 0)
+		return 0;
+
+	if (c + 1 < end && (*c == 'e' || *c == 'E') && (isDigit(c[1]) || c[1] == '-' || c[1] == '+'))
+	{
+		int negative_exponent = 0, written_exponent = 0;
+
+		if (*++c == '-' || *c == '+')
+			negative_exponent = *c++ == '-';
+
+		for (; c < end && isDigit(*c); ++c)
+			written_exponent = 10 * written_exponent + (*c - '0');
+
+		exponent += negative_exponent ? -written_exponent : written_exponent;
+	}
+
+	// Correctly rounded for the usual numbers of TSPLIB, whose digits fit in the mantissa:
+	if (exponent < 0 && exponent >= -22)
+		mantissa /= powers[-exponent];
+	else if (exponent > 0 && exponent <= 22)
+		mantissa *= powers[exponent];
+	else if (exponent != 0)
+		mantissa *= pow(10., exponent);
+
+	*value = negative ? -mantissa : mantissa;
+	reader -> current = c;
+
+	return 1;
+}
+
+
+// Maps the whole file read-only, to be read sequentially and unmapped with munmap(). Returns NULL on failure.
+static const char* mapFile(const char *filename, size_t *file_size)
+{
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
 	{
 		printf("\nFile '%s' not found.\n", filename);
-		exit(EXIT_FAILURE);
+		return NULL;
+	}
+
+	struct stat file_stat;
+
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0)
+	{
+		close(fd);
+		printf("\nEmpty file '%s'.\n", filename);
+		return NULL;
 	}
 
-	char buffer[BUFFER_SIZE] = {0};
-	long end_header_pos = 0;
+	*file_size = file_stat.st_size;
+	const char *data = (const char*) mmap(NULL, *file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
 
-	while (fgets(buffer, BUFFER_SIZE, file) && buffer[0] != ' ' && !isdigit(buffer[0]))
-		end_header_pos = ftell(file); // saving header's end position.
+	if (data == MAP_FAILED)
+	{
+		printf("\nCould not map the file '%s'.\n", filename);
+		return NULL;
+	}
 
-	// printf("buffer: %s\n", buffer);
+	posix_madvise((void*) data, *file_size, POSIX_MADV_SEQUENTIAL);
+
+	return data;
+}
 
-	// Going back to header's end:
-	fseek(file, end_header_pos, SEEK_SET);
 
-	int rank, cities_number = 0;
-	float x, y;
+static void exitInvalid(const char *filename, const char *reason)
+{
+	printf("\nInvalid dataset '%s': %s.\n", filename, reason);
+	exit(EXIT_FAILURE);
+}
+
 
-	while (fscanf(file, "%d %f %f", &rank, &x, &y) == 3)
+// Reads 'index x y' lines, into arrays preallocated for 'capacity' cities, grown when the dimension isn't known.
+// Returns the number of cities read.
+static int readCoordinates(Reader *reader, const char *filename, int dimension, num_map **xs, num_map **ys,
+	int *capacity)
+{
+	int cities_number = 0;
+	double index, x, y;
+
+	while ((dimension <= 0 || cities_number < dimension) && readNumber(reader, &index))
+	{
+		if (!readNumber(reader, &x) || !readNumber(reader, &y))
+			exitInvalid(filename, "truncated coordinates");
+
+		if (cities_number == *capacity)
+		{
+			*capacity = *capacity < 1024 ? 1024 : 2 * *capacity;
+			*xs = (num_map*) realloc(*xs, *capacity * sizeof(num_map));
+			*ys = (num_map*) realloc(*ys, *capacity * sizeof(num_map));
+
+			if (!*xs || !*ys)
+				exitInvalid(filename, "not enough memory");
+		}
+
+		(*xs)[cities_number] = x;
+		(*ys)[cities_number] = y;
 		++cities_number;
+	}
+
+	return cities_number;
+}
+
+
+// Reads the explicit weights of the matrix of 'map', for the given format:
+static void readWeights(Reader *reader, const char *filename, Map *map, WeightFormat format)
+{
+	const int cities_number = map -> CitiesNumber;
+	int overflow = 0;
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const int first = format == UPPER_ROW ? i + 1 : format == UPPER_DIAG_ROW ? i : 0;
+		const int last = format == LOWER_ROW ? i - 1 : format == LOWER_DIAG_ROW ? i : cities_number - 1;
+
+		for (int j = first; j <= last; ++j)
+		{
+			double weight;
+
+			if (!readNumber(reader, &weight))
+				exitInvalid(filename, "truncated EDGE_WEIGHT_SECTION");
+
+			if (weight > NUM_DIST_MAX)
+			{
+				weight = NUM_DIST_MAX;
+				overflow = 1;
+			}
 
-	// printf("Cities number: %d\n", cities_number);
+			map -> Net[netIndex(map -> NetStride, i, j)] = weight;
 
-	// Going back to header's end:
-	fseek(file, end_header_pos, SEEK_SET);
+			if (!TRIANGULAR_NET && format != FULL_MATRIX) // else the same value.
+				map -> Net[netIndex(map -> NetStride, j, i)] = weight;
+		}
+	}
+
+	if (overflow)
+		printf("\nWarning: some distances are too large for their storage type.\n");
+}
 
-	Map *map = createMap(cities_number, CUSTOM, distMode);
 
-	int city_index = 0;
+static EdgeWeightType parseWeightType(const char *filename, const char *value)
+{
+	static const char *names[] = {"EUC_2D", "CEIL_2D", "ATT", "GEO", "EXPLICIT"};
+	static const EdgeWeightType types[] = {EUC_2D, CEIL_2D, ATT, GEO, EXPLICIT};
 
-	while (city_index < cities_number && fscanf(file, "%d %f %f", &rank, &x, &y) == 3)
+	for (int i = 0; i < 5; ++i)
 	{
-		map -> Locations[city_index][0] = x;
-		map -> Locations[city_index][1] = y;
-		// printf("%5d %11.3f %11.3f\n", rank, x, y);
-		++city_index;
+		if (strcmp(value, names[i]) == 0)
+			return types[i];
 	}
 
-	fclose(file);
+	printf("\nUnsupported EDGE_WEIGHT_TYPE '%s' in '%s'.\n", value, filename);
+	exit(EXIT_FAILURE);
+}
 
-	initMap(map, CUSTOM, distMode);
 
-	// printMap(map);
+static WeightFormat parseWeightFormat(const char *filename, const char *value)
+{
+	static const char *names[] = {"FULL_MATRIX", "UPPER_ROW", "UPPER_DIAG_ROW", "LOWER_ROW", "LOWER_DIAG_ROW",
+		"LOWER_COL", "LOWER_DIAG_COL", "UPPER_COL", "UPPER_DIAG_COL"};
+	static const WeightFormat formats[] = {FULL_MATRIX, UPPER_ROW, UPPER_DIAG_ROW, LOWER_ROW, LOWER_DIAG_ROW,
+		UPPER_ROW, UPPER_DIAG_ROW, LOWER_ROW, LOWER_DIAG_ROW};
+
+	for (int i = 0; i < 9; ++i)
+	{
+		if (strcmp(value, names[i]) == 0)
+			return formats[i];
+	}
+
+	printf("\nUnsupported EDGE_WEIGHT_FORMAT '%s' in '%s'.\n", value, filename);
+	exit(EXIT_FAILURE);
+}
+
+
+// Creates the map for the given number of cities, with a matrix for EXPLICIT maps whatever their size:
+static Map* createDatasetMap(const char *filename, int cities_number, EdgeWeightType type, DistanceRounding distMode)
+{
+	if (cities_number < 1)
+		exitInvalid(filename, "no city found");
+
+	Map *map = createMap(cities_number, CUSTOM, type == EUC_2D ? distMode : ROUNDED);
+
+	if (type == EXPLICIT && !map -> Net)
+		map -> Net = createNet(cities_number, &(map -> NetStride));
+
+	if (!map -> Locations || (type == EXPLICIT && !map -> Net))
+		exitInvalid(filename, "not enough memory");
+
+	map -> WeightType = type;
 
 	return map;
 }
+
+
+// Loads a TSPLIB map in a single pass over the memory mapped file, see the header.
+Map* getMapFromDataset(const char *filename, DistanceRounding distMode)
+{
+	size_t file_size;
+	const char *data = mapFile(filename, &file_size);
+
+	if (!data)
+		exit(EXIT_FAILURE);
+
+	Reader reader = {data, data + file_size};
+
+	Map *map = NULL;
+	EdgeWeightType type = EUC_2D;
+	WeightFormat format = FULL_MATRIX;
+
+	int dimension = 0, cities_number = 0, capacity = 0;
+	num_map *xs = NULL, *ys = NULL;
+
+	int in_section = 0; // lines of other sections are skipped.
+	char keyword[WORD_SIZE], value[WORD_SIZE];
+
+	while (1)
+	{
+		skipBlanks(&reader, 1);
+
+		if (reader.current == reader.end)
+			break;
+
+		const char first = *reader.current;
+
+		if (isDigit(first) || first == '-' || first == '+' || first == '.')
+		{
+			if (!in_section && !xs) // file without header.
+				cities_number = readCoordinates(&reader, filename, dimension, &xs, &ys, &capacity);
+			else
+				skipLine(&reader);
+
+			continue;
+		}
+
+		readWord(&reader, keyword);
+
+		if (strcmp(keyword, "EOF") == 0)
+			break;
+
+		else if (strcmp(keyword, "NODE_COORD_SECTION") == 0)
+		{
+			if (type == EXPLICIT)
+				exitInvalid(filename, "coordinates of an EXPLICIT map");
+
+			capacity = dimension;
+			xs = (num_map*) malloc(capacity * sizeof(num_map));
+			ys = (num_map*) malloc(capacity * sizeof(num_map));
+
+			cities_number = readCoordinates(&reader, filename, dimension, &xs, &ys, &capacity);
+			in_section = 1;
+		}
+
+		else if (strcmp(keyword, "EDGE_WEIGHT_SECTION") == 0)
+		{
+			if (type != EXPLICIT || dimension <= 0)
+				exitInvalid(filename, "EDGE_WEIGHT_SECTION without EXPLICIT weights or DIMENSION");
+
+			map = createDatasetMap(filename, dimension, type, distMode);
+			readWeights(&reader, filename, map, format);
+			in_section = 1;
+		}
+
+		else if (strstr(keyword, "_SECTION"))
+		{
+			skipLine(&reader);
+			in_section = 1;
+		}
+
+		else // specification line, as 'KEYWORD : VALUE'.
+		{
+			skipBlanks(&reader, 0);
+
+			if (reader.current < reader.end && *reader.current == ':')
+				++reader.current;
+
+			readWord(&reader, value);
+			skipLine(&reader);
+
+			if (strcmp(keyword, "DIMENSION") == 0)
+				dimension = atoi(value);
+
+			else if (strcmp(keyword, "EDGE_WEIGHT_TYPE") == 0)
+				type = parseWeightType(filename, value);
+
+			else if (strcmp(keyword, "EDGE_WEIGHT_FORMAT") == 0 && strcmp(value, "FUNCTION") != 0)
+				format = parseWeightFormat(filename, value);
+
+			else if (strcmp(keyword, "TYPE") == 0 && strcmp(value, "TSP") != 0)
+			{
+				printf("\nUnsupported TYPE '%s' in '%s', only symmetric TSP are.\n", value, filename);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	munmap((void*) data, file_size);
+
+	if (type == EXPLICIT && !map)
+		exitInvalid(filename, "no EDGE_WEIGHT_SECTION");
+
+	if (type != EXPLICIT)
+	{
+		if (dimension > 0 && cities_number != dimension)
+			exitInvalid(filename, "less coordinates than DIMENSION");
+
+		map = createDatasetMap(filename, cities_number, type, distMode);
+
+		memcpy(map -> Locations[0], xs, cities_number * sizeof(num_map));
+		memcpy(map -> Locations[1], ys, cities_number * sizeof(num_map));
+	}
+
+	free(xs);
+	free(ys);
+
+	initMap(map, CUSTOM, map -> Rounding);
+
+	if (RENUMBERING_MIN_CITIES > 0 && map -> CitiesNumber >= RENUMBERING_MIN_CITIES)
+		renumberCities(map);
+
+	return map;
+}
+
+
+// Reads a TSPLIB tour file, whose cities are numbered from 1, see the header.
+int* readTour(const char *filename, const Map *map)
+{
+	if (!filename || !map)
+	{
+		printf("\nInvalid argument in 'readTour()'.\n\n");
+		return NULL;
+	}
+
+	size_t file_size;
+	const char *data = mapFile(filename, &file_size);
+
+	if (!data)
+		return NULL;
+
+	Reader reader = {data, data + file_size};
+
+	const int cities_number = map -> CitiesNumber;
+
+	int capacity = cities_number, read_number = 0, valid = 1;
+	int *cities = (int*) malloc(capacity * sizeof(int));
+
+	char keyword[WORD_SIZE], value[WORD_SIZE];
+
+	while (cities && valid)
+	{
+		skipBlanks(&reader, 1);
+
+		if (reader.current == reader.end)
+			break;
+
+		const char first = *reader.current;
+
+		if (isDigit(first) || first == '-' || first == '+') // the tour section, or a file without header.
+		{
+			double index;
+
+			while (readNumber(&reader, &index) && index >= 0.)
+			{
+				if (read_number == capacity)
+				{
+					capacity = capacity < 1024 ? 1024 : 2 * capacity;
+					int *new_cities = (int*) realloc(cities, capacity * sizeof(int));
+
+					if (!new_cities)
+					{
+						free(cities);
+						cities = NULL;
+						break;
+					}
+
+					cities = new_cities;
+				}
+
+				cities[read_number++] = index > INT_MAX ? -1 : (int) index - 1;
+			}
+
+			break;
+		}
+
+		readWord(&reader, keyword);
+
+		if (strcmp(keyword, "EOF") == 0)
+			break;
+
+		else if (strcmp(keyword, "TOUR_SECTION") == 0)
+			continue;
+
+		else if (keyword[0] == '\0' || strstr(keyword, "_SECTION")) // unknown section, or character.
+			valid = 0;
+
+		else // specification line, as 'KEYWORD : VALUE'.
+		{
+			skipBlanks(&reader, 0);
+
+			if (reader.current < reader.end && *reader.current == ':')
+				++reader.current;
+
+			readWord(&reader, value);
+			skipLine(&reader);
+
+			if (strcmp(keyword, "TYPE") == 0 && strcmp(value, "TOUR") != 0)
+				valid = 0;
+		}
+	}
+
+	munmap((void*) data, file_size);
+
+	if (!cities || !valid || read_number == 0)
+	{
+		printf("\nCould not read the tour '%s'.\n", filename);
+		free(cities);
+		return NULL;
+	}
+
+	// From the original numbers, if the map has been renumbered:
+	int *new_numbers = map -> OriginalCities ? (int*) malloc(cities_number * sizeof(int)) : NULL;
+
+	if (new_numbers)
+	{
+		for (int city = 0; city < cities_number; ++city)
+			new_numbers[map -> OriginalCities[city]] = city;
+
+		for (int i = 0; i < read_number; ++i)
+			cities[i] = cities[i] >= 0 && cities[i] < cities_number ? new_numbers[cities[i]] : -1;
+
+		free(new_numbers);
+	}
+	else if (map -> OriginalCities)
+	{
+		free(cities);
+		cities = NULL;
+	}
+
+	int *path = !cities || read_number >= cities_number ? cities : (int*) realloc(cities, cities_number * sizeof(int));
+	int inserted_number = path ? repairPath(map, path, path, read_number) : -1;
+
+	if (inserted_number < 0)
+	{
+		printf("\nNot enough memory to read the tour '%s'.\n", filename);
+		free(path ? path : cities);
+		return NULL;
+	}
+
+	const int dropped_number = read_number - (cities_number - inserted_number);
+
+	if (inserted_number || dropped_number)
+		printf("\nTour '%s' repaired for the map: %d cities dropped, %d inserted.\n", filename, dropped_number,
+			inserted_number);
+
+	return path;
+}
+
+
+// Writes the path as a TSPLIB tour file, see the header.
+int writeTour(const char *filename, const char *name, const Map *map, const int *path)
+{
+	if (!filename || !map || !path)
+	{
+		printf("\nInvalid argument in 'writeTour()'.\n\n");
+		return 0;
+	}
+
+	FILE *file = fopen(filename, "w");
+
+	if (!file)
+	{
+		printf("\nCould not write the tour '%s'.\n", filename);
+		return 0;
+	}
+
+	const int cities_number = map -> CitiesNumber;
+
+	fprintf(file, "NAME : %s\nCOMMENT : Length %.6g\nTYPE : TOUR\nDIMENSION : %d\nTOUR_SECTION\n",
+		name ? name : "tour", (double) pathLength(map, path), cities_number);
+
+	for (int i = 0; i < cities_number; ++i)
+		fprintf(file, "%d\n", originalCity(map, path[i]) + 1);
+
+	fprintf(file, "-1\nEOF\n");
+
+	const int success = !ferror(file) & (fclose(file) == 0);
+
+	if (!success)
+		printf("\nCould not write the tour '%s'.\n", filename);
+
+	return success;
+}
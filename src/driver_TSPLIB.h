@@ -5,7 +5,26 @@
 #include "salesman.h"
 
 
+// Maps of at least this many cities are renumbered along a Hilbert curve once loaded, for cache locality
+// (see renumberCities()). Tours are still read, written and printed with the original numbers. 0 to disable.
+#define RENUMBERING_MIN_CITIES 10000
+
+
+// Loads a TSPLIB map, whose EDGE_WEIGHT_TYPE is EUC_2D (the default), CEIL_2D, ATT, GEO or EXPLICIT, with an
+// EDGE_WEIGHT_FORMAT among FULL_MATRIX, UPPER_ROW, LOWER_ROW, UPPER_DIAG_ROW, LOWER_DIAG_ROW, and their column
+// counterparts. 'distMode' only applies to EUC_2D maps, the others being rounded as TSPLIB defines them.
+// Files without header are read as 'index x y' lines. Exits on failure.
 Map* getMapFromDataset(const char *filename, DistanceRounding distMode);
 
 
+// Reads the TOUR_SECTION of a TSPLIB tour file, ended by -1 or EOF, as a path of the given map starting from its first
+// city. Tours of a slightly different map are repaired, see repairPath(). Returns NULL on failure, else the path to free.
+// Cities are numbered as in the dataset, even if the map has been renumbered.
+int* readTour(const char *filename, const Map *map);
+
+
+// Writes the path as a TSPLIB tour file, named 'name' (can be NULL), with its length as comment. Returns 0 on failure.
+int writeTour(const char *filename, const char *name, const Map *map, const int *path);
+
+
 #endif
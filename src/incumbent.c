@@ -0,0 +1,197 @@
+#define _POSIX_C_SOURCE 200809L // for posix_memalign().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "incumbent.h"
+
+
+#define CACHE_LINE 64
+
+
+// Seqlock: 'sequence' is odd while the slot is being written, by its single writer.
+typedef struct
+{
+	uint64_t sequence;
+	double length;
+	int *path;
+	char padding[CACHE_LINE - 2 * sizeof(uint64_t) - sizeof(int*)]; // avoiding false sharing, slots being aligned.
+} IncumbentSlot;
+
+
+struct Incumbent
+{
+	int citiesNumber;
+	int writersNumber;
+	uint64_t bestLength; // bits of a double: positive doubles are ordered as their bits are.
+	IncumbentSlot *slots; // aligned on cache lines.
+};
+
+
+static inline uint64_t doubleToBits(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+
+static inline double bitsToDouble(uint64_t bits)
+{
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+
+Incumbent* createIncumbent(int cities_number, int writers_number)
+{
+	if (cities_number < 1 || writers_number < 1)
+	{
+		printf("\nInvalid argument in 'createIncumbent()'.\n\n");
+		return NULL;
+	}
+
+	Incumbent *incumbent = (Incumbent*) calloc(1, sizeof(Incumbent));
+	void *slots = NULL;
+
+	if (!incumbent || posix_memalign(&slots, CACHE_LINE, writers_number * sizeof(IncumbentSlot)) != 0)
+	{
+		printf("\nNot enough memory to create an incumbent.\n");
+		free(incumbent);
+		return NULL;
+	}
+
+	incumbent -> slots = (IncumbentSlot*) memset(slots, 0, writers_number * sizeof(IncumbentSlot));
+
+	incumbent -> citiesNumber = cities_number;
+	incumbent -> writersNumber = writers_number;
+	incumbent -> bestLength = doubleToBits(INFINITY);
+
+	for (int i = 0; i < writers_number; ++i)
+	{
+		incumbent -> slots[i].length = INFINITY;
+		incumbent -> slots[i].path = (int*) calloc(cities_number, sizeof(int));
+
+		if (!incumbent -> slots[i].path)
+		{
+			printf("\nNot enough memory to create an incumbent.\n");
+			freeIncumbent(&incumbent);
+			return NULL;
+		}
+	}
+
+	return incumbent;
+}
+
+
+// Passed by address:
+void freeIncumbent(Incumbent **incumbent_address)
+{
+	if (!incumbent_address || !*incumbent_address)
+		return;
+
+	Incumbent *incumbent = *incumbent_address;
+
+	for (int i = 0; i < incumbent -> writersNumber; ++i)
+		free(incumbent -> slots[i].path);
+
+	free(incumbent -> slots);
+	free(incumbent);
+	*incumbent_address = NULL;
+}
+
+
+// Publishes the given path in the slot of the given writer, if it is shorter than the incumbent.
+// Each writer must be used by a single thread. Returns 1 if the path has been published.
+int offerPath(Incumbent *incumbent, int writer_index, const int *path, double length)
+{
+	if (length >= getIncumbentLength(incumbent))
+		return 0;
+
+	IncumbentSlot *slot = incumbent -> slots + writer_index;
+	uint64_t sequence = __atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED);
+
+	__atomic_store_n(&(slot -> sequence), sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	memcpy(slot -> path, path, incumbent -> citiesNumber * sizeof(int));
+	slot -> length = length;
+
+	__atomic_store_n(&(slot -> sequence), sequence + 2, __ATOMIC_RELEASE);
+
+	// Lowering the best length, unless another writer did better meanwhile:
+	uint64_t new_bits = doubleToBits(length);
+	uint64_t old_bits = __atomic_load_n(&(incumbent -> bestLength), __ATOMIC_RELAXED);
+
+	while (new_bits < old_bits && !__atomic_compare_exchange_n(&(incumbent -> bestLength), &old_bits, new_bits,
+		1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	return 1;
+}
+
+
+// Length of the incumbent, +INFINITY if none has been published yet. Only an atomic read.
+double getIncumbentLength(const Incumbent *incumbent)
+{
+	return bitsToDouble(__atomic_load_n(&(incumbent -> bestLength), __ATOMIC_ACQUIRE));
+}
+
+
+// Copies the incumbent in 'path_tofill', and saves the index of the writer which found it in 'writer_index'.
+// Both can be NULL. Returns the incumbent length, +INFINITY if none has been published yet.
+double getIncumbent(const Incumbent *incumbent, int *path_tofill, int *writer_index)
+{
+	while (1)
+	{
+		double best_length = INFINITY;
+		int best_index = -1, busy = 0;
+		uint64_t best_sequence = 0;
+
+		for (int i = 0; i < incumbent -> writersNumber; ++i)
+		{
+			const IncumbentSlot *slot = incumbent -> slots + i;
+			uint64_t sequence = __atomic_load_n(&(slot -> sequence), __ATOMIC_ACQUIRE);
+
+			// A better path is being written in this slot, whose previous one is lost: waiting for it.
+			if (sequence % 2 == 1)
+			{
+				busy = 1;
+				break;
+			}
+
+			double length = slot -> length;
+
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED) == sequence && length < best_length)
+			{
+				best_length = length;
+				best_index = i;
+				best_sequence = sequence;
+			}
+		}
+
+		if (busy)
+			continue;
+
+		if (writer_index)
+			*writer_index = best_index;
+
+		if (best_index < 0 || !path_tofill)
+			return best_length;
+
+		const IncumbentSlot *slot = incumbent -> slots + best_index;
+		memcpy(path_tofill, slot -> path, incumbent -> citiesNumber * sizeof(int));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED) == best_sequence)
+			return best_length;
+
+		// The writer published a better path meanwhile, trying again.
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef INCUMBENT_H
+#define INCUMBENT_H
+
+
+// Best path found so far by several concurrent solvers. Each solver, or 'writer', owns a slot where it publishes
+// its improvements, and the best length is kept in an atomic word: neither writers nor readers ever lock.
+
+
+typedef struct Incumbent Incumbent;
+
+
+Incumbent* createIncumbent(int cities_number, int writers_number);
+
+
+// Passed by address:
+void freeIncumbent(Incumbent **incumbent_address);
+
+
+// Publishes the given path in the slot of the given writer, if it is shorter than the incumbent.
+// Each writer must be used by a single thread. Returns 1 if the path has been published.
+int offerPath(Incumbent *incumbent, int writer_index, const int *path, double length);
+
+
+// Length of the incumbent, +INFINITY if none has been published yet. Only an atomic read.
+double getIncumbentLength(const Incumbent *incumbent);
+
+
+// Copies the incumbent in 'path_tofill', and saves the index of the writer which found it in 'writer_index'.
+// Both can be NULL. Returns the incumbent length, +INFINITY if none has been published yet.
+double getIncumbent(const Incumbent *incumbent, int *path_tofill, int *writer_index);
+
+
+#endif
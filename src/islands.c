@@ -0,0 +1,399 @@
+#define _POSIX_C_SOURCE 200809L // for shm_open(), ftruncate(), strdup() and nanosleep().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "islands.h"
+#include "get_time.h"
+
+
+#define ISLANDS_MAGIC 0x6c4962694c6e6547ULL // "GenLibIl"
+#define ISLANDS_VERSION 1
+#define CACHE_LINE 64
+#define JOIN_TIMEOUT 2. // in seconds, for the segment creator to finish its setup.
+
+
+// Shared memory layout: the segment header, then ISLANDS_MAX_NUMBER slots for the best gene of each island,
+// then the ring of 'slotsNumber' migrant slots. Each slot is a SlotHeader followed by the gene bytes.
+
+typedef struct
+{
+	uint64_t magic; // written last by the segment creator.
+	uint32_t version;
+	uint32_t slotsNumber;
+	uint64_t geneSize;
+	uint64_t slotSize;
+	char padding_0[CACHE_LINE - 4 * sizeof(uint64_t)];
+
+	uint64_t head; // number of migrants ever written, each one getting a 'ticket'.
+	char padding_1[CACHE_LINE - sizeof(uint64_t)];
+
+	uint64_t islandsNumber; // number of joinings.
+	char padding_2[CACHE_LINE - sizeof(uint64_t)];
+} SegmentHeader;
+
+
+// Seqlock: 'sequence' is odd while the slot is being written. In the ring, the migrant of ticket 't'
+// is complete once its slot sequence is 2t + 2. Slots of islands have a single writer each.
+typedef struct
+{
+	uint64_t sequence;
+	uint64_t islandId;
+	double fitness;
+} SlotHeader;
+
+
+struct Archipelago
+{
+	char *name;
+	char *segment;
+	size_t segmentSize;
+	size_t geneSize;
+	size_t slotSize;
+	int slotsNumber;
+	int islandIndex;
+	uint64_t islandId;
+	uint64_t cursor; // ticket of the next migrant to read.
+	int stalledMigrations; // number of consecutive migrations stopped at the 'cursor' ticket.
+	double lastPublished;
+	void *migrant; // private copy of a migrant gene.
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions:
+
+static inline SegmentHeader* getHeader(const Archipelago *archipelago)
+{
+	return (SegmentHeader*) archipelago -> segment;
+}
+
+
+static inline SlotHeader* getIslandSlot(const Archipelago *archipelago, int index)
+{
+	return (SlotHeader*) (archipelago -> segment + sizeof(SegmentHeader) + index * archipelago -> slotSize);
+}
+
+
+static inline SlotHeader* getRingSlot(const Archipelago *archipelago, uint64_t ticket)
+{
+	size_t ring_offset = sizeof(SegmentHeader) + ISLANDS_MAX_NUMBER * archipelago -> slotSize;
+	return (SlotHeader*) (archipelago -> segment + ring_offset + (ticket % archipelago -> slotsNumber) * archipelago -> slotSize);
+}
+
+
+static inline void* getSlotGene(SlotHeader *slot)
+{
+	return (char*) slot + sizeof(SlotHeader);
+}
+
+
+static void pause_ms(long milliseconds)
+{
+	struct timespec delay = {0, milliseconds * 1000000L};
+	nanosleep(&delay, NULL);
+}
+
+
+// The island has a single writer, no lock needed:
+static void publishIslandBest(Archipelago *archipelago, const Species *species, const void *gene, double fitness)
+{
+	SlotHeader *slot = getIslandSlot(archipelago, archipelago -> islandIndex);
+	uint64_t sequence = __atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED);
+
+	__atomic_store_n(&(slot -> sequence), sequence + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot -> islandId = archipelago -> islandId;
+	slot -> fitness = fitness;
+	species -> genMeth -> copyGene(species -> context, getSlotGene(slot), gene);
+
+	__atomic_store_n(&(slot -> sequence), sequence + 2, __ATOMIC_RELEASE);
+}
+
+
+// Lock-free for any number of writers, as each one gets its own ticket:
+static void publishMigrant(Archipelago *archipelago, const Species *species, const void *gene, double fitness)
+{
+	uint64_t ticket = __atomic_fetch_add(&(getHeader(archipelago) -> head), 1, __ATOMIC_RELAXED);
+	SlotHeader *slot = getRingSlot(archipelago, ticket);
+
+	__atomic_store_n(&(slot -> sequence), 2 * ticket + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot -> islandId = archipelago -> islandId;
+	slot -> fitness = fitness;
+	species -> genMeth -> copyGene(species -> context, getSlotGene(slot), gene);
+
+	__atomic_store_n(&(slot -> sequence), 2 * ticket + 2, __ATOMIC_RELEASE);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions:
+
+// Creates, or joins if it already exists, the shared memory segment of the given name (e.g "/genlib_tsp").
+// All the processes must use the same 'gene_size' and 'slots_number'. Returns NULL on failure.
+// Note that an island slot is used at each call, even if the same process joins again.
+Archipelago* joinArchipelago(const char *name, size_t gene_size, int slots_number)
+{
+	if (!name || gene_size == 0 || slots_number < 1) {
+		printf("\nInvalid argument in 'joinArchipelago()'.\n\n");
+		return NULL;
+	}
+
+	const size_t slot_size = (sizeof(SlotHeader) + gene_size + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+	const size_t segment_size = sizeof(SegmentHeader) + (ISLANDS_MAX_NUMBER + slots_number) * slot_size;
+
+	int creator = 1;
+	int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+
+	if (fd < 0 && errno == EEXIST)
+	{
+		creator = 0;
+		fd = shm_open(name, O_RDWR, 0600);
+	}
+
+	if (fd < 0) {
+		printf("\nCould not open the shared memory segment '%s'.\n", name);
+		return NULL;
+	}
+
+	if (creator && ftruncate(fd, segment_size) != 0)
+	{
+		printf("\nCould not resize the shared memory segment '%s'.\n", name);
+		close(fd);
+		shm_unlink(name);
+		return NULL;
+	}
+
+	// Waiting for the creator to have resized the segment:
+	struct stat segment_stat = {0};
+	double time_start = get_time();
+
+	while (!creator && (fstat(fd, &segment_stat) != 0 || segment_stat.st_size < (off_t) segment_size)
+		&& get_time() - time_start < JOIN_TIMEOUT)
+	{
+		pause_ms(1);
+	}
+
+	if (!creator && segment_stat.st_size < (off_t) segment_size)
+	{
+		printf("\nCould not join the archipelago '%s': incompatible segment.\n", name);
+		close(fd);
+		return NULL;
+	}
+
+	char *segment = (char*) mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (segment == MAP_FAILED) {
+		printf("\nCould not map the shared memory segment '%s'.\n", name);
+		return NULL;
+	}
+
+	Archipelago *archipelago = (Archipelago*) calloc(1, sizeof(Archipelago));
+
+	if (!archipelago || !(archipelago -> migrant = malloc(gene_size)) || !(archipelago -> name = strdup(name)))
+	{
+		printf("\nNot enough memory to join an archipelago.\n");
+		munmap(segment, segment_size);
+		if (archipelago)
+			free(archipelago -> migrant);
+		free(archipelago);
+		return NULL;
+	}
+
+	archipelago -> segment = segment;
+	archipelago -> segmentSize = segment_size;
+	archipelago -> geneSize = gene_size;
+	archipelago -> slotSize = slot_size;
+	archipelago -> slotsNumber = slots_number;
+	archipelago -> lastPublished = -INFINITY;
+
+	SegmentHeader *header = getHeader(archipelago);
+
+	if (creator)
+	{
+		header -> version = ISLANDS_VERSION;
+		header -> slotsNumber = slots_number;
+		header -> geneSize = gene_size;
+		header -> slotSize = slot_size;
+
+		__atomic_store_n(&(header -> magic), ISLANDS_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	// Waiting for the creator to have written the header:
+	while (__atomic_load_n(&(header -> magic), __ATOMIC_ACQUIRE) != ISLANDS_MAGIC && get_time() - time_start < JOIN_TIMEOUT)
+		pause_ms(1);
+
+	int valid = __atomic_load_n(&(header -> magic), __ATOMIC_ACQUIRE) == ISLANDS_MAGIC && header -> version == ISLANDS_VERSION
+		&& header -> slotsNumber == (uint32_t) slots_number && header -> geneSize == gene_size;
+
+	uint64_t island_index = __atomic_fetch_add(&(header -> islandsNumber), valid, __ATOMIC_RELAXED);
+
+	if (!valid || island_index >= ISLANDS_MAX_NUMBER)
+	{
+		printf("\nCould not join the archipelago '%s': %s.\n", name, valid ? "too many islands" : "incompatible segment");
+		leaveArchipelago(&archipelago, 0);
+		return NULL;
+	}
+
+	archipelago -> islandIndex = island_index;
+	archipelago -> islandId = island_index + 1; // unique in the archipelago, empty slots having the id 0.
+
+	// Catching up with the migrants still in the ring:
+	uint64_t head = __atomic_load_n(&(header -> head), __ATOMIC_ACQUIRE);
+	archipelago -> cursor = head > (uint64_t) slots_number ? head - slots_number : 0;
+	archipelago -> stalledMigrations = 0;
+
+	return archipelago;
+}
+
+
+// Leaving the archipelago, passed by address. The last process to leave should 'unlink' the shared segment.
+void leaveArchipelago(Archipelago **archipelago_address, int unlink)
+{
+	if (!archipelago_address || !*archipelago_address)
+		return;
+
+	Archipelago *archipelago = *archipelago_address;
+
+	munmap(archipelago -> segment, archipelago -> segmentSize);
+
+	if (unlink)
+		shm_unlink(archipelago -> name);
+
+	free(archipelago -> name);
+	free(archipelago -> migrant);
+	free(archipelago);
+	*archipelago_address = NULL;
+}
+
+
+// Publishes the best gene of the species if it improved since its last publication, then offers every new
+// migrant to the species, replacing its worst genes. Returns the number of accepted migrants.
+int migrate(Archipelago *archipelago, Species *species)
+{
+	if (!archipelago || !species) {
+		printf("\nInvalid argument in 'migrate()'.\n\n");
+		return 0;
+	}
+
+	// Emigration:
+
+	double best_fitness;
+	const void *best_gene = getBestGene(species, &best_fitness);
+
+	if (best_fitness > archipelago -> lastPublished)
+	{
+		publishIslandBest(archipelago, species, best_gene, best_fitness);
+		publishMigrant(archipelago, species, best_gene, best_fitness);
+		archipelago -> lastPublished = best_fitness;
+	}
+
+	// Immigration:
+
+	int accepted_number = 0;
+	uint64_t head = __atomic_load_n(&(getHeader(archipelago) -> head), __ATOMIC_ACQUIRE);
+
+	if (head - archipelago -> cursor > (uint64_t) archipelago -> slotsNumber)
+		archipelago -> cursor = head - archipelago -> slotsNumber; // some migrants have been missed.
+
+	while (archipelago -> cursor < head)
+	{
+		const uint64_t ticket = archipelago -> cursor;
+		SlotHeader *slot = getRingSlot(archipelago, ticket);
+
+		uint64_t sequence = __atomic_load_n(&(slot -> sequence), __ATOMIC_ACQUIRE);
+
+		if (sequence < 2 * ticket + 2)
+		{
+			// Either still being written, or its writer died while doing so. In the latter case it would stop
+			// the immigration forever, hence it is skipped once the ring moved far enough, or after a while:
+			if (head - ticket <= (uint64_t) archipelago -> slotsNumber / 2 &&
+				++(archipelago -> stalledMigrations) < ISLANDS_STALLED_MIGRATIONS)
+				break; // to be read at the next migration.
+		}
+
+		else if (sequence == 2 * ticket + 2)
+		{
+			uint64_t island_id = slot -> islandId;
+			species -> genMeth -> copyGene(species -> context, archipelago -> migrant, getSlotGene(slot));
+
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			// Skipping own and overwritten migrants:
+			if (island_id != archipelago -> islandId && __atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED) == sequence)
+				accepted_number += immigrateGene(species, archipelago -> migrant);
+		}
+
+		archipelago -> stalledMigrations = 0;
+		++(archipelago -> cursor);
+	}
+
+	return accepted_number;
+}
+
+
+// Copies the best gene ever published in the archipelago in 'gene_tofill', which can be NULL,
+// using the species 'copyGene' operator. Returns its (unshifted) fitness, or -INFINITY if there is none.
+double getGroupBest(const Archipelago *archipelago, const Species *species, void *gene_tofill)
+{
+	if (!archipelago || !species) {
+		printf("\nInvalid argument in 'getGroupBest()'.\n\n");
+		return -INFINITY;
+	}
+
+	const uint64_t islands_number = __atomic_load_n(&(getHeader(archipelago) -> islandsNumber), __ATOMIC_ACQUIRE);
+	const int slots_number = islands_number < ISLANDS_MAX_NUMBER ? islands_number : ISLANDS_MAX_NUMBER;
+
+	while (1)
+	{
+		double best_fitness = -INFINITY;
+		int best_index = -1;
+		uint64_t best_sequence = 0;
+
+		for (int i = 0; i < slots_number; ++i)
+		{
+			SlotHeader *slot = getIslandSlot(archipelago, i);
+			uint64_t sequence = __atomic_load_n(&(slot -> sequence), __ATOMIC_ACQUIRE);
+
+			if (sequence == 0 || sequence % 2 == 1)
+				continue; // empty, or being written.
+
+			double fitness = slot -> fitness;
+
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED) == sequence && fitness > best_fitness)
+			{
+				best_fitness = fitness;
+				best_index = i;
+				best_sequence = sequence;
+			}
+		}
+
+		if (best_index < 0 || !gene_tofill)
+			return best_fitness;
+
+		SlotHeader *slot = getIslandSlot(archipelago, best_index);
+		species -> genMeth -> copyGene(species -> context, gene_tofill, getSlotGene(slot));
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+		if (__atomic_load_n(&(slot -> sequence), __ATOMIC_RELAXED) == best_sequence)
+			return best_fitness;
+
+		// The island published a better gene meanwhile, trying again.
+	}
+}
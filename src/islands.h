@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////
+// Island model across processes: several OS processes on the same host, each running its own species,
+// exchange their best genes through a POSIX shared memory segment. Migrants are written in a lock-free
+// ring of fixed-size slots, and the best gene of the whole group is always available in the segment.
+// No network service is needed. Optional, requires GenLib.c, GenLib.h, islands.c and islands.h.
+//
+// Genes must be flat memory blocks of 'gene_size' bytes (no inner pointers), since they are serialized
+// by calling the species 'copyGene' operator directly on the shared memory.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ISLANDS_H
+#define ISLANDS_H
+
+#if __cplusplus
+extern "C" {
+#endif
+
+
+#include <stddef.h>
+
+#include "GenLib.h"
+
+
+// Maximum number of islands, i.e processes, sharing a segment. Each one owns a slot for its best gene,
+// hence the group best stays available even if one of the processes crashes.
+#define ISLANDS_MAX_NUMBER 64
+
+// A migrant slot left half-written, e.g by a process killed while publishing, is skipped by the readers
+// once half of the ring has been written after it, or after this number of migrations waiting for it.
+#define ISLANDS_STALLED_MIGRATIONS 16
+
+
+typedef struct Archipelago Archipelago;
+
+
+// Creates, or joins if it already exists, the shared memory segment of the given name (e.g "/genlib_tsp").
+// All the processes must use the same 'gene_size' and 'slots_number'. Returns NULL on failure.
+// Note that an island slot is used at each call, even if the same process joins again.
+Archipelago* joinArchipelago(const char *name, size_t gene_size, int slots_number);
+
+
+// Leaving the archipelago, passed by address. The last process to leave should 'unlink' the shared segment.
+void leaveArchipelago(Archipelago **archipelago_address, int unlink);
+
+
+// Publishes the best gene of the species if it improved since its last publication, then offers every new
+// migrant to the species, replacing its worst genes. Returns the number of accepted migrants.
+int migrate(Archipelago *archipelago, Species *species);
+
+
+// Copies the best gene ever published in the archipelago in 'gene_tofill', which can be NULL,
+// using the species 'copyGene' operator. Returns its (unshifted) fitness, or -INFINITY if there is none.
+double getGroupBest(const Archipelago *archipelago, const Species *species, void *gene_tofill);
+
+
+#if __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "kd_tree.h"
+#include "sales_gen.h" // for swap()
+
+
+static inline num_map coordinate(const KdTree *tree, int city, int dim)
+{
+	return tree -> map -> Locations[dim][city];
+}
+
+
+// Reorders cities[lo, hi) so that cities[nth] is at its sorted position along 'dim', with no greater
+// value before it, and no lower one after it. Average complexity linear in the range length.
+static void selectNth(const KdTree *tree, int lo, int hi, int nth, int dim)
+{
+	int *cities = tree -> Cities;
+
+	while (hi - lo > 1)
+	{
+		num_map pivot = coordinate(tree, cities[(lo + hi) / 2], dim);
+		int i = lo, j = hi - 1;
+
+		while (i <= j)
+		{
+			while (coordinate(tree, cities[i], dim) < pivot)
+				++i;
+
+			while (coordinate(tree, cities[j], dim) > pivot)
+				--j;
+
+			if (i <= j)
+			{
+				swap(cities, i, j);
+				++i;
+				--j;
+			}
+		}
+
+		// Now: [lo, j] <= pivot, [i, hi) >= pivot, and (j, i) == pivot.
+		if (nth <= j)
+			hi = j + 1;
+		else if (nth >= i)
+			lo = i;
+		else
+			return;
+	}
+}
+
+
+static void build(KdTree *tree, int lo, int hi)
+{
+	if (hi - lo <= 0)
+		return;
+
+	// Splitting along the dimension of greater spread:
+
+	num_map min[2] = {coordinate(tree, tree -> Cities[lo], 0), coordinate(tree, tree -> Cities[lo], 1)};
+	num_map max[2] = {min[0], min[1]};
+
+	for (int i = lo + 1; i < hi; ++i)
+	{
+		for (int dim = 0; dim < 2; ++dim)
+		{
+			num_map value = coordinate(tree, tree -> Cities[i], dim);
+
+			if (value < min[dim])
+				min[dim] = value;
+
+			if (value > max[dim])
+				max[dim] = value;
+		}
+	}
+
+	const int dim = max[0] - min[0] >= max[1] - min[1] ? 0 : 1;
+	const int median = (lo + hi) / 2;
+
+	selectNth(tree, lo, hi, median, dim);
+	tree -> SplitDims[median] = dim;
+
+	build(tree, lo, median);
+	build(tree, median + 1, hi);
+}
+
+
+KdTree* createKdTree(const Map *map)
+{
+	KdTree *tree = (KdTree*) calloc(1, sizeof(KdTree));
+
+	if (!tree || !(tree -> Cities = (int*) calloc(map -> CitiesNumber, sizeof(int)))
+		|| !(tree -> SplitDims = (char*) calloc(map -> CitiesNumber, sizeof(char))))
+	{
+		printf("\nNot enough memory to create a k-d tree.\n");
+		freeKdTree(&tree);
+		return NULL;
+	}
+
+	tree -> CitiesNumber = map -> CitiesNumber;
+	tree -> map = map;
+
+	for (int i = 0; i < map -> CitiesNumber; ++i)
+		tree -> Cities[i] = i;
+
+	build(tree, 0, map -> CitiesNumber);
+
+	return tree;
+}
+
+
+// Passed by address:
+void freeKdTree(KdTree **tree)
+{
+	if (!tree || !*tree)
+		return;
+
+	free((*tree) -> Cities);
+	free((*tree) -> SplitDims);
+	free(*tree);
+	*tree = NULL;
+}
+
+
+// Sorted insertion in the current 'k' best neighbors:
+static inline void insertNeighbor(int *neighbors, num_map *sq_distances, int *found_number, int k, int city, num_map sq_dist)
+{
+	int i;
+
+	if (*found_number < k)
+		i = (*found_number)++;
+	else if (sq_dist >= sq_distances[k - 1])
+		return;
+	else
+		i = k - 1;
+
+	while (i > 0 && sq_distances[i - 1] > sq_dist)
+	{
+		neighbors[i] = neighbors[i - 1];
+		sq_distances[i] = sq_distances[i - 1];
+		--i;
+	}
+
+	neighbors[i] = city;
+	sq_distances[i] = sq_dist;
+}
+
+
+static void search(const KdTree *tree, int lo, int hi, int city, int k, int *neighbors, num_map *sq_distances, int *found_number)
+{
+	if (hi - lo <= 0)
+		return;
+
+	const int median = (lo + hi) / 2;
+	const int node = tree -> Cities[median];
+	const int dim = tree -> SplitDims[median];
+
+	if (node != city)
+	{
+		num_map dx = coordinate(tree, node, 0) - coordinate(tree, city, 0);
+		num_map dy = coordinate(tree, node, 1) - coordinate(tree, city, 1);
+
+		insertNeighbor(neighbors, sq_distances, found_number, k, node, dx * dx + dy * dy);
+	}
+
+	num_map diff = coordinate(tree, city, dim) - coordinate(tree, node, dim);
+
+	// Nearest side first:
+	if (diff < 0)
+		search(tree, lo, median, city, k, neighbors, sq_distances, found_number);
+	else
+		search(tree, median + 1, hi, city, k, neighbors, sq_distances, found_number);
+
+	// The other side may only be skipped if it is farther than the current k-th neighbor:
+	if (*found_number < k || diff * diff < sq_distances[k - 1])
+	{
+		if (diff < 0)
+			search(tree, median + 1, hi, city, k, neighbors, sq_distances, found_number);
+		else
+			search(tree, lo, median, city, k, neighbors, sq_distances, found_number);
+	}
+}
+
+
+// Finds the 'k' nearest cities of the given one, itself excluded, and saves them in 'neighbors', nearest
+// first. 'sq_distances' is a buffer of 'k' values, allocated once for all the queries. Returns the number of found
+// neighbors, which is lower than 'k' only if there aren't enough cities.
+int nearestNeighbors(const KdTree *tree, int city, int k, int *neighbors, num_map *sq_distances)
+{
+	if (k <= 0)
+		return 0;
+
+	int found_number = 0;
+
+	search(tree, 0, tree -> CitiesNumber, city, k, neighbors, sq_distances, &found_number);
+
+	return found_number;
+}
@@ -0,0 +1,32 @@
+#ifndef KD_TREE_H
+#define KD_TREE_H
+
+
+#include "salesman.h"
+
+
+// 2-d tree over the cities locations, built in O(n log n), and answering nearest neighbors queries
+// in O(log n) on average. The tree is implicit: each node is the median of its range in 'Cities'.
+typedef struct
+{
+	int CitiesNumber;
+	int *Cities; // cities, ordered as the tree nodes.
+	char *SplitDims; // splitting dimension of each node, 0 for x, 1 for y.
+	const Map *map;
+} KdTree;
+
+
+KdTree* createKdTree(const Map *map);
+
+
+// Passed by address:
+void freeKdTree(KdTree **tree);
+
+
+// Finds the 'k' nearest cities of the given one, itself excluded, and saves them in 'neighbors', nearest
+// first. 'sq_distances' is a buffer of 'k' values, allocated once for all the queries. Returns the number of found
+// neighbors, which is lower than 'k' only if there aren't enough cities.
+int nearestNeighbors(const KdTree *tree, int city, int k, int *neighbors, num_map *sq_distances);
+
+
+#endif
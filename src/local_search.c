@@ -1,24 +1,303 @@
+#define _POSIX_C_SOURCE 200809L // for pthreads.
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "local_search.h"
 #include "sales_gen.h"
+#include "tour.h"
+#include "moves.h"
 #include "get_time.h"
 #include "rng32.h"
 
 
 #define EPSILON 0.000001
+#define CACHE_LINE 64
+
+
+static const char *LC_StringArray[] = {"STOCHASTIC", "GREEDY", "SA", "TA", "TWO_OPT", "LIN_KERNIGHAN"}; // hardcoded for now.
+
+
+// State shared by the threads searching the same population. The greedy search ends each of its epochs together,
+// so that all threads stop on the change number of the whole population: 'epochEnd' is a barrier, whose size
+// is 'participants', as a thread failing to start must leave it.
+typedef struct
+{
+	pthread_mutex_t lock; // guards all the fields.
+	pthread_cond_t epochEnd;
+	int stop;
+	int populationSize; // searched by the participants.
+	int participants;
+	int arrived;
+	long generation; // number of ended epochs.
+	long changeSum; // of the current epoch.
+	int stopVote; // of the current epoch.
+	long lastChangeSum; // of the last ended epoch.
+	int lastStopVote;
+} SharedControl;
+
+
+// Private state used to stop the search, and to publish its progress:
+typedef struct
+{
+	double timeStart;
+	double lastPublication;
+	long changeNumber; // applied moves, for the modes counting them.
+	SharedControl *shared; // NULL if single threaded.
+} SearchControl;
+
+
+static double bestPathIndex(const Map *map, int **population, int population_size, int *best_index)
+{
+	double best_length = +INFINITY;
+
+	for (int i = 0; i < population_size; ++i)
+	{
+		double current_length = pathLength(map, population[i]);
+
+		if (current_length < best_length)
+		{
+			best_length = current_length;
+			*best_index = i;
+		}
+	}
+
+	return best_length;
+}
+
+
+// Indexes (i, j) of the 2-opt move adding an edge between the cities at positions p and q, the other new edge
+// linking their successors if 'forward', else their predecessors. Returns 0 if the move is void, or would move
+// the first city.
+static inline int candidateMove(int p, int q, int forward, int *i, int *j)
+{
+	const int lo = p < q ? p : q, hi = p < q ? q : p;
+
+	*i = forward ? lo + 1 : lo;
+	*j = forward ? hi : hi - 1;
+
+	return *i >= 1 && *j > *i;
+}
+
+
+// Uniformly picks one of the given neighborhoods:
+static inline MoveType drawMoveType(void *rng, int neighborhoods)
+{
+	if (neighborhoods == MOVE_2OPT)
+		return MOVE_2OPT;
+
+	MoveType types[3];
+	int types_number = 0;
+
+	for (int type = MOVE_2OPT; type <= MOVE_3OPT; type <<= 1)
+	{
+		if (neighborhoods & type)
+			types[types_number++] = type;
+	}
+
+	return types[rng32_nextInt(rng) % types_number];
+}
+
+
+// Draws a random move from the given neighborhoods. If the map has candidate lists, the move adds an edge between
+// a random city and one of its candidates. Returns 0 if the drawn move must be skipped.
+static inline int drawMove(const Map *map, void *rng, const int *path, const int *positions, int neighborhoods,
+	Move *move)
+{
+	const int cities_number = map -> CitiesNumber;
+	const MoveType type = drawMoveType(rng, neighborhoods);
+
+	if (type == MOVE_2OPT)
+	{
+		move -> insertion = -1;
+
+		if (map -> CandidatesNumber > 0)
+		{
+			int city = rng32_nextInt(rng) % cities_number;
+			uint32_t roll = rng32_nextInt(rng);
+			int candidate = getCandidates(map, city)[(roll >> 1) % map -> CandidatesNumber];
+
+			return candidateMove(positions[city], positions[candidate], roll & 1, &move -> start, &move -> end);
+		}
+
+		getStrictCouple(rng, &move -> start, &move -> end, cities_number - 1); // First city fixed!
+
+		++move -> start;
+		++move -> end;
+
+		// Preventing useless symmetric representation:
+		if (SYMMETRY_PREVENTION && move -> start == 1 && path[move -> end] > path[1])
+			++move -> start; // To not lose a mutation!
+
+		return 1;
+	}
+
+	// Segment insertion:
+
+	int max_length = type == MOVE_OR_OPT ? OR_OPT_MAX_LENGTH : SEGMENT_INSERTION_MAX_LENGTH;
+
+	if (max_length > cities_number - 2)
+		max_length = cities_number - 2;
+
+	const int length = 1 + rng32_nextInt(rng) % max_length;
+
+	move -> start = 1 + rng32_nextInt(rng) % (cities_number - length);
+	move -> end = move -> start + length - 1;
+
+	uint32_t roll = rng32_nextInt(rng);
+	move -> reversed = roll & 1;
+
+	if (map -> CandidatesNumber > 0)
+	{
+		// Either after the candidate, or mirrored before it, so that the segment start is linked to it:
+		int candidate = getCandidates(map, path[move -> start])[(roll >> 1) % map -> CandidatesNumber];
+		int position = positions[candidate];
+
+		move -> insertion = !move -> reversed ? position : position == 0 ? cities_number - 1 : position - 1;
+
+		return move -> insertion < move -> start - 1 || move -> insertion > move -> end;
+	}
+
+	move -> insertion = (roll >> 1) % (cities_number - length - 1);
+
+	if (move -> insertion >= move -> start - 1)
+		move -> insertion += length + 1;
+
+	return 1;
+}
+
+
+// Writes back the paths held by two-level lists:
+static void syncPaths(TwoLevelList **lists, int **population, int population_size)
+{
+	for (int i = 0; i < population_size; ++i)
+		listToPath(lists[i], population[i]);
+}
+
+
+// Called at the end of each epoch. Publishes from time to time the best path to the incumbent, if any,
+// and checks the stopping conditions. Returns 1 if the search must stop. If 'lists' is not NULL,
+// the paths are written back from them before being read.
+static int checkpoint(const LocalSearchSettings *settings, SearchControl *control, const Map *map, int **population,
+	int population_size, TwoLevelList **lists)
+{
+	if (settings -> timeBudget <= 0. && settings -> targetLength <= 0. && !settings -> incumbent)
+		return 0;
+
+	const double time = get_time();
+	int stop = settings -> timeBudget > 0. && time - control -> timeStart >= settings -> timeBudget;
+
+	if (control -> shared)
+	{
+		pthread_mutex_lock(&control -> shared -> lock);
+		stop |= control -> shared -> stop;
+		pthread_mutex_unlock(&control -> shared -> lock);
+	}
+
+	if (settings -> incumbent || settings -> targetLength > 0.)
+	{
+		if (stop || time - control -> lastPublication >= LS_PUBLICATION_PERIOD)
+		{
+			control -> lastPublication = time;
+
+			if (lists)
+				syncPaths(lists, population, population_size);
+
+			int best_index = 0;
+			double best_length = bestPathIndex(map, population, population_size, &best_index);
+
+			// The writer is shared by the threads, which must take turns:
+			if (settings -> incumbent)
+			{
+				if (control -> shared)
+					pthread_mutex_lock(&control -> shared -> lock);
+
+				offerPath(settings -> incumbent, settings -> incumbentWriter, population[best_index], best_length);
+
+				if (control -> shared)
+					pthread_mutex_unlock(&control -> shared -> lock);
+			}
+
+			stop |= best_length <= settings -> targetLength;
+		}
+
+		if (settings -> incumbent)
+			stop |= getIncumbentLength(settings -> incumbent) <= settings -> targetLength;
+	}
+
+	if (stop && control -> shared)
+	{
+		pthread_mutex_lock(&control -> shared -> lock);
+		control -> shared -> stop = 1;
+		pthread_mutex_unlock(&control -> shared -> lock);
+	}
+
+	return stop;
+}
+
+
+// Called with the lock held, by the last thread arriving at the end of an epoch:
+static void endEpoch(SharedControl *shared)
+{
+	shared -> lastChangeSum = shared -> changeSum;
+	shared -> lastStopVote = shared -> stopVote;
+	shared -> changeSum = 0;
+	shared -> stopVote = 0;
+	shared -> arrived = 0;
+	++(shared -> generation);
+
+	pthread_cond_broadcast(&shared -> epochEnd);
+}
+
+
+// Waits for all the threads to end the current epoch. Returns the sum of their change numbers,
+// and sets 'stop' if any of them wants to stop, so that they all take the same decision.
+static long waitEpochEnd(SharedControl *shared, int change_number, int *stop)
+{
+	pthread_mutex_lock(&shared -> lock);
+
+	shared -> changeSum += change_number;
+	shared -> stopVote |= *stop;
+
+	const long generation = shared -> generation;
+
+	if (++(shared -> arrived) == shared -> participants)
+		endEpoch(shared);
+	else
+	{
+		while (shared -> generation == generation)
+			pthread_cond_wait(&shared -> epochEnd, &shared -> lock);
+	}
+
+	// Not overwritten yet, as the next epoch cannot end without this thread:
+	const long change_sum = shared -> lastChangeSum;
+	*stop = shared -> lastStopVote;
+
+	pthread_mutex_unlock(&shared -> lock);
+
+	return change_sum;
+}
+
+
+// For a thread which won't take part in the next epochs:
+static void leaveEpochs(SharedControl *shared)
+{
+	pthread_mutex_lock(&shared -> lock);
 
+	if (--(shared -> participants) == shared -> arrived && shared -> arrived > 0)
+		endEpoch(shared);
 
-static const char *LC_StringArray[] = {"STOCHASTIC", "GREEDY", "SA", "TA"}; // hardcoded for now.
+	pthread_mutex_unlock(&shared -> lock);
+}
 
 
 // Stochastically greedy, can easily be trapped in local minima, although it may still go out early on.
 // Still, close in solutions quality to GA for small-medium problems, but quite faster. Will always output
 // the best found solution found during the run.
-static void stochastic_method(const void *context, const Map *map, void *rng, int **population, int population_size, long epoch_number)
+static void stochastic_method(const LocalSearchSettings *settings, SearchControl *control, const Map *map, void *rng, int **population, int population_size, long epoch_number)
 {
 	epoch_number /= population_size; // To be fair compared to previous algorithms.
 
@@ -29,121 +308,117 @@ static void stochastic_method(const void *context, const Map *map, void *rng, in
 		for (int path_index = 0; path_index < population_size; ++path_index)
 		{
 			int *path = population[path_index];
+			int *positions = settings -> workspace -> positions + (size_t) path_index * cities_number;
 
-			int i, j;
-
-			getStrictCouple(rng, &i, &j, cities_number - 1); // First city fixed!
-
-			++i;
-			++j;
-
-			// Preventing useless symmetric representation:
-			if (SYMMETRY_PREVENTION && i == 1 && path[j] > path[1])
-				++i; // To not lose a mutation!
+			Move move;
 
-			int city_pi = path[i - 1], city_i = path[i];
-			int city_j = path[j], city_sj = j == cities_number - 1 ? 0 : path[j + 1];
+			if (!drawMove(map, rng, path, positions, settings -> neighborhoods, &move))
+				continue;
 
-			// Old length - new length:
-			double delta = map -> Net[city_pi][city_i] + map -> Net[city_j][city_sj]
-						 - map -> Net[city_pi][city_j] - map -> Net[city_i][city_sj];
+			double delta = moveDelta(map, path, &move);
 
-			if (delta > EPSILON) // Shorter path! Mirroring the subpath of indexes [i, j]:
+			if (delta > EPSILON) // Shorter path!
 			{
-				mirror(path, i, j);
+				applyMove(path, positions, &move);
 			}
 		}
+
+		if (checkpoint(settings, control, map, population, population_size, NULL))
+			break;
 	}
 }
 
 
 // ...
-static void simulated_annealing(const void *context, const Map *map, void *rng, int **population, int population_size, long epoch_number)
+static void simulated_annealing(const LocalSearchSettings *settings, SearchControl *control, const Map *map, void *rng, int **population, int population_size, long epoch_number)
 {
-	float temperature = *(float*) context;
+	float temperature = settings -> temperature;
 
 	epoch_number /= population_size; // To be fair compared to previous algorithms.
 
 	const int cities_number = map -> CitiesNumber;
 
-	double *best_found_length_array = NULL;
+	double *best_found_length_array = settings -> workspace -> lengthArray;
+	double *length_array = settings -> workspace -> currentLengthArray; // kept up to date from the moves deltas.
 
-	if (SAVE_BEST_PATH)
-	{
-		best_found_length_array = (double*) calloc(population_size, sizeof(double));
+	// Acceptance probabilities exp(-x) for x in [0, SA_EXP_RANGE], independent of the temperature. Moves
+	// beyond this range are always rejected, their probability being negligible (below 1.2e-7 by default):
+	float exp_table[SA_EXP_TABLE_SIZE + 1];
 
-		for (int path_index = 0; path_index < population_size; ++path_index)
-		{
-			best_found_length_array[path_index] = pathLength(map, population[path_index]); // initial length.
-		}
+	for (int i = 0; i <= SA_EXP_TABLE_SIZE; ++i)
+		exp_table[i] = expf(-SA_EXP_RANGE * i / SA_EXP_TABLE_SIZE);
+
+	const float exp_scale = SA_EXP_TABLE_SIZE / SA_EXP_RANGE;
+
+	for (int path_index = 0; path_index < population_size; ++path_index)
+	{
+		length_array[path_index] = pathLength(map, population[path_index]); // initial length.
+		best_found_length_array[path_index] = length_array[path_index];
 	}
 
 	for (long epoch = 0; epoch < epoch_number; ++epoch)
 	{
+		const float index_scale = exp_scale / temperature;
+
 		for (int path_index = 0; path_index < population_size; ++path_index)
 		{
 			int *path = population[path_index];
+			int *positions = settings -> workspace -> positions + (size_t) path_index * cities_number;
 
-			int i, j;
+			Move move;
 
-			getStrictCouple(rng, &i, &j, cities_number - 1); // First city fixed!
+			if (!drawMove(map, rng, path, positions, settings -> neighborhoods, &move))
+				continue;
 
-			++i;
-			++j;
+			double delta = moveDelta(map, path, &move);
 
-			// Preventing useless symmetric representation:
-			if (SYMMETRY_PREVENTION && i == 1 && path[j] > path[1])
-				++i; // To not lose a mutation!
-
-			int city_pi = path[i - 1], city_i = path[i];
-			int city_j = path[j], city_sj = j == cities_number - 1 ? 0 : path[j + 1];
+			if (delta <= 0.)
+			{
+				float index = (float) -delta * index_scale; // linearly interpolated.
 
-			// Old length - new length:
-			double delta = map -> Net[city_pi][city_i] + map -> Net[city_j][city_sj]
-						 - map -> Net[city_pi][city_j] - map -> Net[city_i][city_sj];
+				if (!(index < SA_EXP_TABLE_SIZE)) // also NaN, once the temperature is down to 0.
+					continue;
 
-			float move_probability = delta > 0. ? 1.f : expf(delta / temperature); // ... precomputing?
-			// float move_probability = 1.f / (1.f + expf(-delta / temperature));
+				int i = (int) index;
+				float move_probability = exp_table[i] + (index - i) * (exp_table[i + 1] - exp_table[i]);
 
-			float roll = rng32_nextFloat(rng);
+				if (rng32_nextFloat(rng) >= move_probability)
+					continue;
+			}
 
-			if (roll < move_probability)
-			{
-				mirror(path, i, j);
+			applyMove(path, positions, &move);
 
-				if (SAVE_BEST_PATH)
-				{
-					double new_length = pathLength(map, path);
+			length_array[path_index] -= delta;
 
-					if (new_length < best_found_length_array[path_index])
-						best_found_length_array[path_index] = new_length;
-				}
-			}
+			if (SAVE_BEST_PATH && length_array[path_index] < best_found_length_array[path_index])
+				best_found_length_array[path_index] = length_array[path_index];
 		}
 
 		temperature *= SA_TEMP_MULTIPLIER;
+
+		if (checkpoint(settings, control, map, population, population_size, NULL))
+			break;
 	}
 
-	printf("Final temperature: %f\n", temperature);
+	if (settings -> verbose)
+		printf("Final temperature: %f\n", temperature);
 
 	if (SAVE_BEST_PATH)
 	{
 		for (int path_index = 0; path_index < population_size; ++path_index)
 		{
-			if (best_found_length_array[path_index] < pathLength(map, population[path_index]))
+			if (settings -> verbose && best_found_length_array[path_index] < length_array[path_index])
 				printf("Best found path than final for index %2d: %.3f\n",
 					path_index, best_found_length_array[path_index]);
 		}
-
-		free(best_found_length_array);
 	}
 }
 
 
 // ...
-static void threshold_acceptance(const void *context, const Map *map, void *rng, int **population, int population_size, long epoch_number)
+static void threshold_acceptance(const LocalSearchSettings *settings, SearchControl *control, const Map *map, void *rng, int **population, int population_size, long epoch_number)
 {
-	float temperature = *(float*) context;
+	float temperature = settings -> temperature;
 
 	epoch_number /= population_size; // To be fair compared to previous algorithms.
 
@@ -154,194 +429,1093 @@ static void threshold_acceptance(const void *context, const Map *map, void *rng,
 		for (int path_index = 0; path_index < population_size; ++path_index)
 		{
 			int *path = population[path_index];
+			int *positions = settings -> workspace -> positions + (size_t) path_index * cities_number;
+
+			Move move;
+
+			if (!drawMove(map, rng, path, positions, settings -> neighborhoods, &move))
+				continue;
+
+			double delta = moveDelta(map, path, &move);
+
+			if (delta > -temperature)
+			{
+				applyMove(path, positions, &move);
+			}
+		}
+
+		temperature *= SA_TEMP_MULTIPLIER;
+
+		if (checkpoint(settings, control, map, population, population_size, NULL))
+			break;
+	}
+
+	if (settings -> verbose)
+		printf("Final temperature: %f\n", temperature);
+}
+
+
+// Best 2-opt move adding a candidate edge, in O(n * k) instead of O(n^2):
+static void bestCandidateMove(const Map *map, const int *path, const int *positions, double *max_delta,
+	Move *best_move)
+{
+	for (int p = 0; p < map -> CitiesNumber; ++p)
+	{
+		const int *candidates = getCandidates(map, path[p]);
+
+		for (int c = 0; c < map -> CandidatesNumber; ++c)
+		{
+			for (int forward = 0; forward < 2; ++forward)
+			{
+				Move move = {.insertion = -1};
 
-			int i, j;
+				if (!candidateMove(p, positions[candidates[c]], forward, &move.start, &move.end))
+					continue;
+
+				double delta = moveDelta(map, path, &move);
+
+				if (delta > *max_delta)
+				{
+					*max_delta = delta;
+					*best_move = move;
+				}
+			}
+		}
+	}
+}
 
-			getStrictCouple(rng, &i, &j, cities_number - 1); // First city fixed!
 
-			++i;
-			++j;
+// Best 2-opt move, in O(n^2):
+static void bestFullMove(const Map *map, const int *path, double *max_delta, Move *best_move)
+{
+	const int cities_number = map -> CitiesNumber;
 
+	for (int i = 1; i < cities_number - 1; ++i)
+	{
+		for (int j = i + 1; j < cities_number; ++j)
+		{
 			// Preventing useless symmetric representation:
 			if (SYMMETRY_PREVENTION && i == 1 && path[j] > path[1])
-				++i; // To not lose a mutation!
+				continue;
 
-			int city_pi = path[i - 1], city_i = path[i];
-			int city_j = path[j], city_sj = j == cities_number - 1 ? 0 : path[j + 1];
+			Move move = {.start = i, .end = j, .insertion = -1};
 
-			// Old length - new length:
-			double delta = map -> Net[city_pi][city_i] + map -> Net[city_j][city_sj]
-						 - map -> Net[city_pi][city_j] - map -> Net[city_i][city_sj];
+			double delta = moveDelta(map, path, &move);
 
-			if (delta > -temperature)
+			if (delta > *max_delta)
 			{
-				mirror(path, i, j);
+				*max_delta = delta;
+				*best_move = move;
 			}
 		}
+	}
+}
 
-		temperature *= SA_TEMP_MULTIPLIER;
+
+// Looks for the segment insertion moves linking the given city, at an end of the moved segment, to one of its
+// neighbors: candidates if any, else all cities. The best one is saved in 'best_move' if better than 'max_delta'.
+// Returns 1 if 'best_move' has been updated.
+static int searchSegmentMoves(const Map *map, const int *path, const int *positions, int city, int max_length,
+	Move *best_move, double *max_delta)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int use_candidates = map -> CandidatesNumber > 0;
+	const int neighbors_number = use_candidates ? map -> CandidatesNumber : cities_number;
+	const int *candidates = use_candidates ? getCandidates(map, city) : NULL;
+	const int city_position = positions[city];
+
+	int found = 0;
+
+	for (int length = 1; length <= max_length; ++length)
+	{
+		// The city is the first of the segment on side 0, the last on side 1:
+		for (int side = 0; side < (length == 1 ? 1 : 2); ++side)
+		{
+			Move move;
+
+			move.start = side == 0 ? city_position : city_position - length + 1;
+			move.end = move.start + length - 1;
+
+			if (move.start < 1 || move.end > cities_number - 1)
+				continue;
+
+			for (int k = 0; k < neighbors_number; ++k)
+			{
+				int neighbor_position = positions[use_candidates ? candidates[k] : k];
+
+				if (neighbor_position >= move.start && neighbor_position <= move.end)
+					continue;
+
+				// Inserting the segment right after the neighbor, or right before it:
+				for (move.reversed = 0; move.reversed < 2; ++move.reversed)
+				{
+					const int after = side == move.reversed;
+
+					move.insertion = after ? neighbor_position : neighbor_position == 0 ? cities_number - 1 :
+						neighbor_position - 1;
+
+					if (move.insertion >= move.start - 1 && move.insertion <= move.end)
+						continue;
+
+					double delta = moveDelta(map, path, &move);
+
+					if (delta > *max_delta)
+					{
+						*max_delta = delta;
+						*best_move = move;
+						found = 1;
+					}
+				}
+			}
+		}
 	}
 
-	printf("Final temperature: %f\n", temperature);
+	return found;
 }
 
 
 // Completely deterministic - and quite greedy! This _will_ get stuck in local minima.
 // This requires the population to be initialized randomly (else, better have a 'population_size' of 1).
-// Empirically provides good results, but squales quadratically with the number of cities.
-static void greedy_method(const void *context, const Map *map, void *rng, int **population, int population_size, long epoch_number)
+// Empirically provides good results, but squales quadratically with the number of cities,
+// unless candidate lists are built, in which case only moves adding a candidate edge are scanned.
+static void greedy_method(const LocalSearchSettings *settings, SearchControl *control, const Map *map, void *rng, int **population, int population_size, long epoch_number)
 {
 	epoch_number /= population_size; // To be fair compared to previous algorithms.
 
 	const int cities_number = map -> CitiesNumber;
+	const int max_length = segmentMaxLength(settings -> neighborhoods);
 
-	for (long epoch = 0; epoch < epoch_number; ++epoch)
+	// When multithreaded, the loop must be left by all threads at the same epoch, even if they don't have the same
+	// number of them: each one votes to stop after its last epoch.
+	for (long epoch = 0; epoch < epoch_number || control -> shared; ++epoch)
 	{
 		int change_number = 0;
 
 		for (int path_index = 0; path_index < population_size; ++path_index)
 		{
 			int *path = population[path_index];
+			int *positions = settings -> workspace -> positions + (size_t) path_index * cities_number;
 
 			double max_delta = EPSILON;
-			int best_i = 0, best_j = 0;
+			Move best_move = {0};
 
-			for (int i = 1; i < cities_number - 1; ++i)
+			if (settings -> neighborhoods & MOVE_2OPT)
 			{
-				for (int j = i + 1; j < cities_number; ++j)
-				{
-					// Preventing useless symmetric representation:
-					if (SYMMETRY_PREVENTION && i == 1 && path[j] > path[1])
-						continue;
-
-					int city_pi = path[i - 1], city_i = path[i];
-					int city_j = path[j], city_sj = j == cities_number - 1 ? 0 : path[j + 1];
-
-					// Old length - new length:
-					double delta = map -> Net[city_pi][city_i] + map -> Net[city_j][city_sj]
-								 - map -> Net[city_pi][city_j] - map -> Net[city_i][city_sj];
-
-					if (delta > max_delta)
-					{
-						max_delta = delta;
-						best_i = i;
-						best_j = j;
-					}
-				}
+				if (map -> CandidatesNumber > 0)
+					bestCandidateMove(map, path, positions, &max_delta, &best_move);
+				else
+					bestFullMove(map, path, &max_delta, &best_move);
 			}
 
-			if (max_delta > EPSILON) // Shorter path! Mirroring the subpath of indexes [i, j]:
+			for (int city = 0; city < cities_number && max_length > 0; ++city)
+				searchSegmentMoves(map, path, positions, city, max_length, &best_move, &max_delta);
+
+			if (max_delta > EPSILON) // Shorter path!
 			{
-				mirror(path, best_i, best_j);
+				applyMove(path, positions, &best_move);
 				++change_number;
 			}
 		}
 
-		// The following stopping mechanisms would hinder tasks parallelization:
+		control -> changeNumber += change_number;
+
+		int stop = checkpoint(settings, control, map, population, population_size, NULL);
+
+		if (control -> shared)
+		{
+			stop |= epoch + 1 >= epoch_number;
+
+			const long change_sum = waitEpochEnd(control -> shared, change_number, &stop);
 
-		if ((float) change_number / population_size < STOPPING_THRESHOLD)
+			if (stop || (float) change_sum / control -> shared -> populationSize < STOPPING_THRESHOLD)
+				break;
+		}
+		else
 		{
-			printf("\nStopping! (change number: %d)\n", change_number);
-			return;
+			if ((float) change_number / population_size < STOPPING_THRESHOLD)
+			{
+				if (settings -> verbose)
+					printf("\nStopping! (change number: %d)\n", change_number);
+				return;
+			}
+
+			if (stop)
+				break;
 		}
 	}
 }
 
 
-// Local search using 2-op heuristic. Returns the best found length:
-double localSearch(const void *context, const Map *map, int population_size, long epoch_number, localSearchMode mode)
+static inline void pushCity(CityQueue *queue, int city, int cities_number)
 {
-	printf("\nLocal search mode: %s\n", LC_StringArray[mode]);
+	if (queue -> queued[city])
+		return;
 
-	double time_start = get_time();
+	int index = queue -> start + queue -> size;
 
-	int **population = (int**) calloc(population_size, sizeof(int*));
+	queue -> cities[index >= cities_number ? index - cities_number : index] = city;
+	queue -> queued[city] = 1;
+	++queue -> size;
+}
 
-	if (!map || !population || population_size < 1 || epoch_number < 0)
-	{
-		printf("\nInvalid argument in 'localSearch()'.\n\n");
-		exit(EXIT_FAILURE);
-	}
 
-	const int cities_number = map -> CitiesNumber;
+static inline int popCity(CityQueue *queue, int cities_number)
+{
+	int city = queue -> cities[queue -> start];
 
-	if (cities_number <= 3)
-	{
-		printf("Trivial case, to be handled separately.\n");
-		exit(EXIT_FAILURE);
-	}
+	queue -> start = queue -> start + 1 == cities_number ? 0 : queue -> start + 1;
+	queue -> queued[city] = 0;
+	--queue -> size;
 
-	rng32 rng;
-	uint64_t seed = DETERMINISTIC ? DEFAULT_SEED : create_seed(population);
-	rng32_init(&rng, seed, 0);
+	return city;
+}
 
-	// Initialization:
 
-	for (int i = 0; i < population_size; ++i)
+// Looks for an improving segment insertion move linking the given city, at an end of the moved segment, to one of its
+// neighbors: candidates if any, else all cities. The first one found is applied, and the endpoints of the changed
+// edges are queued again. Only relies on the tour operations, hence works with two-level lists as well.
+// Returns 1 if the path has been improved.
+static int improveSegment(const Map *map, Tour *tour, CityQueue *queue, int max_length, int city)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int use_candidates = map -> CandidatesNumber > 0;
+	const int neighbors_number = use_candidates ? map -> CandidatesNumber : cities_number;
+	const int *candidates = use_candidates ? getCandidates(map, city) : NULL;
+	const num_dist *candidates_distances = use_candidates ? getCandidatesDistances(map, city) : NULL;
+
+	for (int forward = 1; forward >= 0; --forward)
 	{
-		population[i] = (int*) calloc(cities_number, sizeof(int));
+		// The segment goes from 'city' to 'end', away from 'before', and is followed by 'after':
+		const int before = forward ? tourPrev(tour, city) : tourNext(tour, city);
+		int end = city;
 
-		if (population[i] == NULL)
+		for (int length = 1; length <= max_length; ++length)
 		{
-			printf("Memory error.\n");
-			exit(EXIT_FAILURE);
-		}
+			if (length > 1)
+				end = forward ? tourNext(tour, end) : tourPrev(tour, end);
 
-		// *_RANDOM_INIT best for greedy_method()
-		initPath(&rng, population[i], cities_number, BIASED_RANDOM_INIT);
-	}
+			const int after = forward ? tourNext(tour, end) : tourPrev(tour, end);
 
-	// Search:
+			if (end == before || after == before)
+				break;
 
-	if (mode == STOCHASTIC)
-		stochastic_method(context, map, &rng, population, population_size, epoch_number);
-	else if (mode == GREEDY)
-		greedy_method(context, map, &rng, population, population_size, epoch_number);
-	else if (mode == SA)
-		simulated_annealing(context, map, &rng, population, population_size, epoch_number);
-	else if (mode == TA)
-		threshold_acceptance(context, map, &rng, population, population_size, epoch_number);
-	else
-	{
+			if (length == 1 && !forward) // same moves as forward.
+				continue;
+
+			// Gain of closing the gap left by the segment:
+			const double removal_gain = getDistance(map, before, city) + getDistance(map, end, after)
+				- getDistance(map, before, after);
+
+			if (removal_gain <= EPSILON)
+				continue;
+
+			for (int k = 0; k < neighbors_number; ++k)
+			{
+				const int city_c = use_candidates ? candidates[k] : k;
+				const double dist_c = use_candidates ? candidates_distances[k] : getDistance(map, city, city_c);
+
+				// Candidates being sorted, the next ones can't do better:
+				if (removal_gain - dist_c <= EPSILON)
+				{
+					if (use_candidates)
+						break;
+					continue;
+				}
+
+				if (city_c == before || city_c == after ||
+					(forward ? tourBetween(tour, city, city_c, end) : tourBetween(tour, end, city_c, city)))
+					continue;
+
+				// Inserting the segment between 'c' and its successor (side 1) or predecessor (side 0), linking 'c' to 'city':
+				for (int side = 1; side >= 0; --side)
+				{
+					const int city_d = side ? tourNext(tour, city_c) : tourPrev(tour, city_c);
+
+					if (city_d == before || city_d == after)
+						continue;
+
+					double delta = removal_gain - dist_c + getDistance(map, city_c, city_d) - getDistance(map, end, city_d);
+
+					if (delta > EPSILON)
+					{
+						pushCity(queue, before, cities_number);
+						pushCity(queue, city, cities_number);
+						pushCity(queue, end, cities_number);
+						pushCity(queue, after, cities_number);
+						pushCity(queue, city_c, cities_number);
+						pushCity(queue, city_d, cities_number);
+
+						const int city_a = side ? city_c : city_d, city_b = side ? city_d : city_c;
+
+						if (forward)
+							tourMoveSegment(tour, city, end, city_a, city_b, !side);
+						else
+							tourMoveSegment(tour, end, city, city_a, city_b, side);
+
+						return 1;
+					}
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+// Looks for an improving move from the given neighborhoods, removing an edge of the given city. The first one found
+// is applied, and the endpoints of the changed edges are queued again. Returns 1 if the path has been improved.
+static int improveCity(const Map *map, Tour *tour, CityQueue *queue, int neighborhoods, int city_a)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int use_candidates = map -> CandidatesNumber > 0;
+	const int neighbors_number = use_candidates ? map -> CandidatesNumber : cities_number;
+	const int *candidates = use_candidates ? getCandidates(map, city_a) : NULL;
+	const num_dist *candidates_distances = use_candidates ? getCandidatesDistances(map, city_a) : NULL;
+
+	for (int forward = 1; forward >= 0 && (neighborhoods & MOVE_2OPT); --forward)
+	{
+		int city_b = forward ? tourNext(tour, city_a) : tourPrev(tour, city_a);
+		double dist_ab = getDistance(map, city_a, city_b);
+
+		for (int k = 0; k < neighbors_number; ++k)
+		{
+			int city_c = use_candidates ? candidates[k] : k;
+
+			if (city_c == city_a)
+				continue;
+
+			// Gain of replacing (a, b) by (a, c). Candidates being sorted, the next ones can't do better:
+			double gain = dist_ab - (use_candidates ? candidates_distances[k] : getDistance(map, city_a, city_c));
+
+			if (gain <= EPSILON)
+			{
+				if (use_candidates)
+					break;
+				continue;
+			}
+
+			int city_d = forward ? tourNext(tour, city_c) : tourPrev(tour, city_c);
+
+			if (city_c == city_b || city_d == city_a)
+				continue;
+
+			// Old length - new length, (c, d) being replaced by (b, d):
+			double delta = gain + getDistance(map, city_c, city_d) - getDistance(map, city_b, city_d);
+
+			if (delta > EPSILON)
+			{
+				if (forward)
+					tourReverse(tour, city_b, city_c); // a b ... c d -> a c ... b d
+				else
+					tourReverse(tour, city_c, city_b); // d c ... b a -> d b ... c a
+
+				pushCity(queue, city_a, cities_number);
+				pushCity(queue, city_b, cities_number);
+				pushCity(queue, city_c, cities_number);
+				pushCity(queue, city_d, cities_number);
+				return 1;
+			}
+		}
+	}
+
+	const int max_length = segmentMaxLength(neighborhoods);
+
+	return max_length > 0 && improveSegment(map, tour, queue, max_length, city_a);
+}
+
+
+// Lin-Kernighan step: looks for the best 't3' to link to 'last', and its opposite 't4', maximizing the lookahead
+// gain: g(t3, t4) - g(last, t3), while keeping 'gain' - g(last, t3) positive. Edges added by the previous steps
+// must not be removed. Up to 'breadth' steps are saved in 'steps', best first. Returns the number of saved steps.
+typedef struct
+{
+	int t3;
+	int t4;
+	double lookahead;
+} KernighanStep;
+
+
+static int kernighanSteps(const Map *map, const Tour *tour, int t1, int last, double gain, const int *added_edges,
+	int added_number, KernighanStep *steps, int breadth)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int use_candidates = map -> CandidatesNumber > 0;
+	const int neighbors_number = use_candidates ? map -> CandidatesNumber : cities_number;
+	const int *candidates = use_candidates ? getCandidates(map, last) : NULL;
+	const num_dist *candidates_distances = use_candidates ? getCandidatesDistances(map, last) : NULL;
+
+	int steps_number = 0;
+
+	for (int k = 0; k < neighbors_number; ++k)
+	{
+		int t3 = use_candidates ? candidates[k] : k;
+		double dist_last_t3 = use_candidates ? candidates_distances[k] : getDistance(map, last, t3);
+
+		double partial_gain = gain - dist_last_t3;
+
+		if (partial_gain <= EPSILON)
+		{
+			if (use_candidates)
+				break; // sorted candidates.
+			continue;
+		}
+
+		if (t3 == t1 || t3 == last)
+			continue;
+
+		int t4 = tourOpposite(tour, t1, last, t3);
+
+		if (t4 == last || t4 == t1)
+			continue;
+
+		// (t3, t4) must not have been added:
+		int tabu = 0;
+
+		for (int i = 0; i < added_number && !tabu; ++i)
+		{
+			int a = added_edges[2 * i], b = added_edges[2 * i + 1];
+			tabu = (a == t3 && b == t4) || (a == t4 && b == t3);
+		}
+
+		if (tabu)
+			continue;
+
+		KernighanStep step = {t3, t4, getDistance(map, t3, t4) - dist_last_t3};
+
+		// Sorted insertion:
+		int i = steps_number < breadth ? steps_number++ : breadth;
+
+		while (i > 0 && steps[i - 1].lookahead < step.lookahead)
+		{
+			if (i < breadth)
+				steps[i] = steps[i - 1];
+			--i;
+		}
+
+		if (i < breadth)
+			steps[i] = step;
+	}
+
+	return steps_number;
+}
+
+
+// Lin-Kernighan move from the city 't1': its edge (t1, t2) is removed, then 2-opt moves are chained, each one removing
+// the edge (t1, last) added by the previous one to close the path, until no positive gain is possible. The best prefix
+// of the chain is kept, if it improves the path. Several alternatives are tried for the first move. The endpoints
+// of the changed edges are queued again. Returns 1 if the path has been improved.
+static int improveCityLK(const Map *map, Tour *tour, CityQueue *queue, int t1)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	int flips[LK_MAX_DEPTH][4];
+	int added_edges[2 * LK_MAX_DEPTH];
+
+	for (int forward = 1; forward >= 0; --forward)
+	{
+		const int t2 = forward ? tourNext(tour, t1) : tourPrev(tour, t1);
+
+		KernighanStep first_steps[LK_BREADTH];
+
+		int first_number = kernighanSteps(map, tour, t1, t2, getDistance(map, t1, t2), NULL, 0, first_steps,
+			LK_BREADTH);
+
+		for (int alternative = 0; alternative < first_number; ++alternative)
+		{
+			KernighanStep step = first_steps[alternative];
+
+			int last = t2, depth = 0, best_depth = 0;
+			double gain = getDistance(map, t1, t2), best_gain = EPSILON;
+
+			while (1)
+			{
+				// Removing (t3, t4), adding (last, t3), and closing with (t4, t1):
+				tourMove2Opt(tour, t1, last, step.t3, step.t4);
+
+				flips[depth][0] = t1;
+				flips[depth][1] = last;
+				flips[depth][2] = step.t3;
+				flips[depth][3] = step.t4;
+
+				added_edges[2 * depth] = last;
+				added_edges[2 * depth + 1] = step.t3;
+
+				gain += step.lookahead;
+				++depth;
+
+				double closed_gain = gain - getDistance(map, step.t4, t1);
+
+				if (closed_gain > best_gain)
+				{
+					best_gain = closed_gain;
+					best_depth = depth;
+				}
+
+				last = step.t4;
+
+				if (depth == LK_MAX_DEPTH || !kernighanSteps(map, tour, t1, last, gain, added_edges, depth, &step, 1))
+					break;
+			}
+
+			// Undoing the moves after the best one, by removing the edges they added:
+			for (int i = depth - 1; i >= best_depth; --i)
+				tourMove2Opt(tour, flips[i][0], flips[i][3], flips[i][2], flips[i][1]);
+
+			if (best_depth > 0)
+			{
+				for (int i = 0; i < best_depth; ++i)
+				{
+					for (int j = 0; j < 4; ++j)
+						pushCity(queue, flips[i][j], cities_number);
+				}
+
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+
+// Queues all the cities, in path order:
+static void queueAll(CityQueue *queue, const int *path, int cities_number)
+{
+	for (int i = 0; i < cities_number; ++i)
+		pushCity(queue, path[i], cities_number);
+
+	queue -> improved = 0;
+}
+
+
+// Returns 1 if 'b' is a candidate of 'a', or the converse:
+static inline int isCandidateEdge(const Map *map, int a, int b)
+{
+	const int *candidates_a = getCandidates(map, a), *candidates_b = getCandidates(map, b);
+
+	for (int k = 0; k < map -> CandidatesNumber; ++k)
+	{
+		if (candidates_a[k] == b || candidates_b[k] == a)
+			return 1;
+	}
+
+	return 0;
+}
+
+
+// Queues the cities of a warm started path with an edge out of the candidate lists, where improvements are likely
+// found. The others are then checked by the final pass over all cities, which is forced.
+static void queueUnusual(CityQueue *queue, const Map *map, const int *path)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	for (int i = 0, prev = path[cities_number - 1]; i < cities_number; prev = path[i++])
+	{
+		if (!isCandidateEdge(map, prev, path[i]))
+		{
+			pushCity(queue, prev, cities_number);
+			pushCity(queue, path[i], cities_number);
+		}
+	}
+
+	queue -> improved = 1;
+}
+
+
+// First improvement local search, with 2-opt moves by default, or Lin-Kernighan ones: each epoch, a city is taken
+// from the queue of each path, and the first improving move around it is applied. A city whose neighborhood didn't
+// improve isn't looked at again until one of its edges changes (don't-look bits). Once the queue is empty, all cities
+// are checked once more, since don't-look bits may miss some moves: this stops at a true local optimum of the used
+// neighborhoods (with respect to the candidate lists, if any). Paths are held by two-level lists if 'use_lists'.
+static void first_improvement_method(const LocalSearchSettings *settings, SearchControl *control, const Map *map, int **population, int population_size, long epoch_number, int lin_kernighan, int use_lists)
+{
+	epoch_number /= population_size; // To be fair compared to previous algorithms.
+
+	const int cities_number = map -> CitiesNumber;
+
+	LocalSearchWorkspace *workspace = settings -> workspace;
+	TwoLevelList **lists = use_lists ? workspace -> lists : NULL;
+
+	for (int path_index = 0; path_index < population_size; ++path_index)
+	{
+		CityQueue *queue = workspace -> queues + path_index;
+
+		queue -> cities = workspace -> queuesCities + (size_t) path_index * cities_number;
+		queue -> queued = workspace -> queuesFlags + (size_t) path_index * cities_number;
+		queue -> start = 0;
+		queue -> size = 0;
+
+		memset(queue -> queued, 0, cities_number * sizeof(char));
+
+		if (path_index < settings -> seedPathsNumber && map -> CandidatesNumber > 0)
+			queueUnusual(queue, map, population[path_index]);
+		else
+			queueAll(queue, population[path_index], cities_number);
+
+		if (lists)
+			listFromPath(lists[path_index], population[path_index], cities_number);
+	}
+
+	long epoch = 0;
+	int active_number = population_size;
+
+	for (; epoch < epoch_number && active_number > 0; ++epoch)
+	{
+		active_number = 0;
+
+		for (int path_index = 0; path_index < population_size; ++path_index)
+		{
+			CityQueue *queue = workspace -> queues + path_index;
+
+			if (queue -> size == 0)
+			{
+				if (!queue -> improved)
+					continue;
+
+				queueAll(queue, population[path_index], cities_number);
+			}
+
+			++active_number;
+
+			Tour tour = {population[path_index], workspace -> positions + (size_t) path_index * cities_number,
+				cities_number, lists ? lists[path_index] : NULL};
+
+			int city = popCity(queue, cities_number);
+			int improved = 0;
+
+			if (lin_kernighan)
+				improved = improveCityLK(map, &tour, queue, city)
+					|| improveCity(map, &tour, queue, settings -> neighborhoods & ~MOVE_2OPT, city);
+			else
+				improved = improveCity(map, &tour, queue, settings -> neighborhoods, city);
+
+			queue -> improved |= improved;
+			control -> changeNumber += improved;
+		}
+
+		if (checkpoint(settings, control, map, population, population_size, lists))
+			break;
+	}
+
+	if (lists)
+		syncPaths(lists, population, population_size);
+
+	if (settings -> verbose)
+		printf("\n%s after %ld epochs (change number: %ld)\n", active_number == 0 ? "Local optimum reached" :
+			"Stopping", epoch, control -> changeNumber);
+}
+
+
+// Zero initialized, and aligned on a cache line. Returns NULL on memory error.
+static void* alignedCalloc(size_t number, size_t size)
+{
+	void *memory = NULL;
+
+	if (posix_memalign(&memory, CACHE_LINE, number * size) != 0)
+		return NULL;
+
+	memset(memory, 0, number * size);
+
+	return memory;
+}
+
+
+// Number of paths of the share of the thread 't', and index of its first one:
+static int sliceSize(int population_size, int threads_number, int t, int *first)
+{
+	const int size = population_size / threads_number, remainder = population_size % threads_number;
+
+	*first = t * size + (t < remainder ? t : remainder);
+
+	return size + (t < remainder);
+}
+
+
+// Offset, in elements, of the share of the thread 't' in an array holding 'cities_number' elements per path.
+// Rounded up to a cache line, so that threads never write on the same ones: the arrays of the workspace have
+// a cache line of slack per path, there being at most that many threads.
+static size_t sliceOffset(int first, int t, int cities_number, size_t element_size)
+{
+	const size_t start = (size_t) first * cities_number * element_size + (size_t) t * CACHE_LINE;
+
+	return (start + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE / element_size;
+}
+
+
+// Makes sure the workspace can hold the given population, returns 0 on memory error:
+static int reserveWorkspace(LocalSearchWorkspace *workspace, int population_size, int cities_number)
+{
+	if (population_size <= workspace -> populationCapacity && cities_number <= workspace -> citiesCapacity)
+		return 1;
+
+	freeLocalSearchWorkspace(workspace);
+
+	const size_t slack = (size_t) population_size * CACHE_LINE; // for the alignment of the threads shares, see sliceOffset().
+
+	workspace -> population = (int**) calloc(population_size, sizeof(int*));
+	workspace -> paths = (int*) alignedCalloc((size_t) population_size * cities_number + slack / sizeof(int), sizeof(int));
+	workspace -> lengthArray = (double*) calloc(population_size, sizeof(double));
+	workspace -> currentLengthArray = (double*) calloc(population_size, sizeof(double));
+	workspace -> positions = (int*) alignedCalloc((size_t) population_size * cities_number + slack / sizeof(int), sizeof(int));
+	workspace -> queues = (CityQueue*) calloc(population_size, sizeof(CityQueue));
+	workspace -> queuesCities = (int*) alignedCalloc((size_t) population_size * cities_number + slack / sizeof(int), sizeof(int));
+	workspace -> queuesFlags = (char*) alignedCalloc((size_t) population_size * cities_number + slack, sizeof(char));
+
+	if (!workspace -> population || !workspace -> paths || !workspace -> lengthArray || !workspace -> currentLengthArray
+		|| !workspace -> positions || !workspace -> queues || !workspace -> queuesCities || !workspace -> queuesFlags)
+	{
+		freeLocalSearchWorkspace(workspace);
+		return 0;
+	}
+
+	workspace -> populationCapacity = population_size;
+	workspace -> citiesCapacity = cities_number;
+
+	return 1;
+}
+
+
+// Creates the two-level lists of the workspace, if not done yet. Returns 0 on memory error.
+static int reserveLists(LocalSearchWorkspace *workspace)
+{
+	if (workspace -> lists)
+		return 1;
+
+	if (!(workspace -> lists = (TwoLevelList**) calloc(workspace -> populationCapacity, sizeof(TwoLevelList*))))
+		return 0;
+
+	for (int i = 0; i < workspace -> populationCapacity; ++i)
+	{
+		if (!(workspace -> lists[i] = createTwoLevelList(workspace -> citiesCapacity)))
+			return 0;
+	}
+
+	return 1;
+}
+
+
+void freeLocalSearchWorkspace(LocalSearchWorkspace *workspace)
+{
+	if (!workspace)
+		return;
+
+	if (workspace -> lists)
+	{
+		for (int i = 0; i < workspace -> populationCapacity; ++i)
+			freeTwoLevelList(workspace -> lists + i);
+
+		free(workspace -> lists);
+	}
+
+	free(workspace -> population);
+	free(workspace -> paths);
+	free(workspace -> lengthArray);
+	free(workspace -> currentLengthArray);
+	free(workspace -> positions);
+	free(workspace -> queues);
+	free(workspace -> queuesCities);
+	free(workspace -> queuesFlags);
+
+	*workspace = (LocalSearchWorkspace) {0};
+}
+
+
+static void runMethod(const LocalSearchSettings *settings, SearchControl *control, const Map *map, void *rng,
+	int **population, int population_size, long epoch_number, localSearchMode mode, int use_lists)
+{
+	if (mode == STOCHASTIC)
+		stochastic_method(settings, control, map, rng, population, population_size, epoch_number);
+	else if (mode == GREEDY)
+		greedy_method(settings, control, map, rng, population, population_size, epoch_number);
+	else if (mode == SA)
+		simulated_annealing(settings, control, map, rng, population, population_size, epoch_number);
+	else if (mode == TA)
+		threshold_acceptance(settings, control, map, rng, population, population_size, epoch_number);
+	else if (mode == TWO_OPT || mode == LIN_KERNIGHAN)
+		first_improvement_method(settings, control, map, population, population_size, epoch_number,
+			mode == LIN_KERNIGHAN, use_lists);
+	else
+	{
 		printf("\nUnsupported local search mode.\n");
 		exit(EXIT_FAILURE);
 	}
+}
 
-	// Getting the best found path:
 
-	double best_length = +INFINITY;
+// Share of the population searched by a thread, as an independent population: its settings point to a view
+// of the workspace, starting at its first path. Padded, since the RNG and the control are written all the time.
+typedef struct
+{
+	LocalSearchSettings settings;
+	LocalSearchWorkspace workspace;
+	SearchControl control;
+	rng32 rng;
+	const Map *map;
+	int populationSize;
+	long epochNumber;
+	localSearchMode mode;
+	int useLists;
+	char padding[64];
+} SearchTask;
 
-	int *best_path = (int*) calloc(cities_number, sizeof(int));
 
-	for (int i = 0; i < population_size; ++i)
+static void* searchTask(void *arg)
+{
+	SearchTask *task = (SearchTask*) arg;
+
+	runMethod(&task -> settings, &task -> control, task -> map, &task -> rng, task -> workspace.population,
+		task -> populationSize, task -> epochNumber, task -> mode, task -> useLists);
+
+	return NULL;
+}
+
+
+// Splits the population of the workspace between threads, each one with its own RNG stream. They share the stopping
+// conditions, and take turns to publish to the incumbent. Returns 0 on memory error.
+static int parallelSearch(const LocalSearchSettings *settings, const Map *map, uint64_t seed, double time_start,
+	int population_size, long epoch_number, localSearchMode mode, int use_lists, int threads_number)
+{
+	SearchTask *tasks = (SearchTask*) calloc(threads_number, sizeof(SearchTask));
+	pthread_t *threads = (pthread_t*) calloc(threads_number, sizeof(pthread_t));
+	int *started = (int*) calloc(threads_number, sizeof(int));
+
+	if (!tasks || !threads || !started)
 	{
-		double current_length = pathLength(map, population[i]);
+		free(tasks);
+		free(threads);
+		free(started);
+		return 0;
+	}
 
-		if (current_length < best_length)
+	const LocalSearchWorkspace *workspace = settings -> workspace;
+	const int cities_number = map -> CitiesNumber;
+
+	SharedControl shared = {.populationSize = population_size, .participants = threads_number};
+	pthread_mutex_init(&shared.lock, NULL);
+	pthread_cond_init(&shared.epochEnd, NULL);
+
+	for (int t = 0; t < threads_number; ++t)
+	{
+		SearchTask *task = tasks + t;
+
+		int first = 0;
+		const int size = sliceSize(population_size, threads_number, t, &first);
+
+		task -> workspace = (LocalSearchWorkspace) {
+			.population = workspace -> population + first,
+			.paths = workspace -> paths + sliceOffset(first, t, cities_number, sizeof(int)),
+			.lengthArray = workspace -> lengthArray + first,
+			.currentLengthArray = workspace -> currentLengthArray + first,
+			.positions = workspace -> positions + sliceOffset(first, t, cities_number, sizeof(int)),
+			.queues = workspace -> queues + first,
+			.queuesCities = workspace -> queuesCities + sliceOffset(first, t, cities_number, sizeof(int)),
+			.queuesFlags = workspace -> queuesFlags + sliceOffset(first, t, cities_number, sizeof(char)),
+			.lists = workspace -> lists ? workspace -> lists + first : NULL,
+			.populationCapacity = size,
+			.citiesCapacity = workspace -> citiesCapacity};
+
+		task -> settings = *settings;
+		task -> settings.workspace = &task -> workspace;
+		task -> settings.verbose = 0;
+		task -> settings.seedPaths = settings -> seedPathsNumber > first ? settings -> seedPaths + first : NULL;
+		task -> settings.seedPathsNumber = settings -> seedPathsNumber > first ? settings -> seedPathsNumber - first : 0;
+
+		task -> control = (SearchControl) {.timeStart = time_start, .lastPublication = time_start, .shared = &shared};
+
+		rng32_init(&task -> rng, seed, t);
+
+		task -> map = map;
+		task -> populationSize = size;
+		task -> epochNumber = (long) ((double) epoch_number * size / population_size); // same epochs per path.
+		task -> mode = mode;
+		task -> useLists = use_lists;
+	}
+
+	for (int t = 0; t < threads_number; ++t)
+	{
+		started[t] = pthread_create(threads + t, NULL, searchTask, tasks + t) == 0;
+
+		if (!started[t]) // done by this thread afterwards.
+			leaveEpochs(&shared);
+	}
+
+	for (int t = 0; t < threads_number; ++t)
+	{
+		if (started[t])
+			pthread_join(threads[t], NULL);
+	}
+
+	long change_number = 0;
+
+	for (int t = 0; t < threads_number; ++t)
+	{
+		if (!started[t])
 		{
-			best_length = current_length;
+			shared.populationSize = tasks[t].populationSize;
+			shared.participants = 1;
+			searchTask(tasks + t);
+		}
+
+		change_number += tasks[t].control.changeNumber;
+	}
+
+	if (settings -> verbose)
+		printf("\nSearch done by %d threads (change number: %ld)\n", threads_number, change_number);
+
+	pthread_cond_destroy(&shared.epochEnd);
+	pthread_mutex_destroy(&shared.lock);
+
+	free(tasks);
+	free(threads);
+	free(started);
+
+	return 1;
+}
+
+
+// Local search using 2-opt, Or-opt and 3-opt moves. Returns the best found length. Settings can be NULL, for a verbose search.
+double localSearch(const LocalSearchSettings *settings, const Map *map, int population_size, long epoch_number,
+	localSearchMode mode)
+{
+	double time_start = get_time();
+
+	LocalSearchWorkspace local_workspace = {0};
+
+	LocalSearchSettings current_settings = {.temperature = LS_DEFAULT_TEMPERATURE, .verbose = 1};
+
+	if (settings)
+		current_settings = *settings;
+
+	if (!current_settings.workspace)
+		current_settings.workspace = &local_workspace;
+
+	if (!current_settings.neighborhoods)
+		current_settings.neighborhoods = MOVE_2OPT;
+
+	// The gap is checked as a target length:
+	if (current_settings.lowerBound > 0. && current_settings.targetGap > 0.)
+	{
+		const double gap_length = current_settings.lowerBound * (1. + current_settings.targetGap);
+
+		if (gap_length > current_settings.targetLength)
+			current_settings.targetLength = gap_length;
+	}
+
+	if (current_settings.verbose)
+		printf("\nLocal search mode: %s\n", LC_StringArray[mode]);
+
+	if (!map || population_size < 1 || epoch_number < 0 || (current_settings.seedPathsNumber > 0
+		&& !current_settings.seedPaths))
+	{
+		printf("\nInvalid argument in 'localSearch()'.\n\n");
+		exit(EXIT_FAILURE);
+	}
+
+	const int cities_number = map -> CitiesNumber;
+
+	if (cities_number <= 3)
+	{
+		printf("Trivial case, to be handled separately.\n");
+		exit(EXIT_FAILURE);
+	}
 
-			memcpy(best_path, population[i], cities_number * sizeof(int));
+	if (!reserveWorkspace(current_settings.workspace, population_size, cities_number))
+	{
+		printf("Memory error.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	const int use_lists = (mode == TWO_OPT || mode == LIN_KERNIGHAN) && (current_settings.tourStructure == LIST_TOUR
+		|| (current_settings.tourStructure == AUTO_TOUR && cities_number >= LIST_TOUR_MIN_CITIES));
+
+	if (use_lists && !reserveLists(current_settings.workspace))
+	{
+		printf("Memory error.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	int **population = current_settings.workspace -> population;
+
+	rng32 rng;
+	uint64_t seed = DETERMINISTIC ? DEFAULT_SEED : create_seed(population);
+	rng32_init(&rng, seed, 0);
+
+	const int threads_number = current_settings.threadsNumber < population_size ? current_settings.threadsNumber :
+		population_size;
+
+	// Initialization, the paths of each thread being in its own share of the workspace:
+
+	const int shares_number = threads_number > 1 ? threads_number : 1;
+
+	for (int t = 0; t < shares_number; ++t)
+	{
+		int first = 0;
+		const int size = sliceSize(population_size, shares_number, t, &first);
+
+		int *paths = current_settings.workspace -> paths + sliceOffset(first, t, cities_number, sizeof(int));
+		int *positions = current_settings.workspace -> positions + sliceOffset(first, t, cities_number, sizeof(int));
+
+		for (int i = first; i < first + size; ++i, paths += cities_number, positions += cities_number)
+		{
+			population[i] = paths;
+
+			if (i < current_settings.seedPathsNumber)
+				seedPath(population[i], current_settings.seedPaths[i], cities_number);
+			else // *_RANDOM_INIT best for greedy_method()
+				initPath(map, &rng, population[i], current_settings.initMode);
+
+			for (int j = 0; j < cities_number; ++j)
+				positions[population[i][j]] = j;
 		}
 	}
 
+	// Search:
+
+	if (threads_number <= 1)
+	{
+		SearchControl control = {.timeStart = time_start, .lastPublication = time_start};
+
+		runMethod(&current_settings, &control, map, &rng, population, population_size, epoch_number, mode, use_lists);
+	}
+	else if (!parallelSearch(&current_settings, map, seed, time_start, population_size, epoch_number, mode,
+		use_lists, threads_number))
+	{
+		printf("Memory error.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Getting the best found path:
+
+	int best_index = 0;
+	double best_length = bestPathIndex(map, population, population_size, &best_index);
+
+	if (current_settings.incumbent)
+		offerPath(current_settings.incumbent, current_settings.incumbentWriter, population[best_index], best_length);
+
+	if (current_settings.bestPath)
+		memcpy(current_settings.bestPath, population[best_index], cities_number * sizeof(int));
+
 	double elapsed_time = get_time() - time_start;
 
-	printf("\nLocal search:\n -> Time elapsed: %.3f s, best found length: %.3f\n\nBest path:\n",
-		elapsed_time, best_length);
+	if (current_settings.verbose)
+	{
+		printf("\nLocal search:\n -> Time elapsed: %.3f s, best found length: %.3f\n", elapsed_time, best_length);
 
-	// Printing the best found path:
+		if (current_settings.lowerBound > 0.)
+			printf(" -> Lower bound: %.3f, gap: %.3f %%\n", current_settings.lowerBound,
+				100. * (best_length / current_settings.lowerBound - 1.));
 
-	printPath(best_path, cities_number);
+		printf("\nBest path:\n");
 
-	// Freeing everything:
+		// Printing the best found path:
 
-	free(best_path);
+		printPath(map, population[best_index]);
+	}
 
-	for (int i = 0; i < population_size; ++i)
-		free(population[i]);
+	// Freeing everything:
 
-	free(population);
+	freeLocalSearchWorkspace(&local_workspace);
 
 	return best_length;
 }
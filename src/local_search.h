@@ -3,10 +3,15 @@
 
 
 #include "salesman.h" // for inlining
+#include "incumbent.h"
+#include "moves.h"
+#include "two_level_list.h"
 
 
 #define STOPPING_THRESHOLD 0.01
 #define SA_TEMP_MULTIPLIER 0.99f
+#define SA_EXP_TABLE_SIZE 1024 // acceptance probabilities of SA, tabulated...
+#define SA_EXP_RANGE 16.f // for -delta / temperature up to this value.
 
 #define SAVE_BEST_PATH 1 // only for SA as of now.
 
@@ -14,12 +19,93 @@
 #define DETERMINISTIC 0
 #define DEFAULT_SEED 123456 // used when DETERMINISTIC = 1
 
-typedef enum {STOCHASTIC, GREEDY, SA, TA} localSearchMode;
+#define LS_DEFAULT_TEMPERATURE 0.1f // used when no settings are given.
+
+#define LS_PUBLICATION_PERIOD 0.01 // in seconds, between two publications to the incumbent.
+
+#define LK_MAX_DEPTH 50 // maximum number of 2-opt moves chained by LIN_KERNIGHAN.
+#define LK_BREADTH 5 // alternatives tried for the first of these moves.
+
+#define LIST_TOUR_MIN_CITIES 5000 // AUTO_TOUR uses two-level lists from this many cities.
+
+// TWO_OPT: first improvement local search with don't-look bits, stopping at a local optimum. Much faster on large
+// maps once candidate lists are built (see initCandidates()), else every city is tried as a neighbor.
+// LIN_KERNIGHAN: same, but with variable depth moves made of sequential 2-opt moves, tried before the other
+// neighborhoods (if any). Slower per move, but reaches much better local optima.
+typedef enum {STOCHASTIC, GREEDY, SA, TA, TWO_OPT, LIN_KERNIGHAN} localSearchMode;
+
+
+// FIFO of the cities to look at, the others having their don't-look bit set:
+typedef struct
+{
+	int *cities;
+	char *queued;
+	int start;
+	int size;
+	int improved; // since the last time all cities were queued.
+} CityQueue;
+
+
+// Tour structure of TWO_OPT and LIN_KERNIGHAN: arrays, with O(n) reversals, or two-level lists (see two_level_list.h),
+// with O(sqrt(n)) ones but slower queries. AUTO_TOUR picks the latter for large maps. Other modes use arrays.
+typedef enum {AUTO_TOUR, ARRAY_TOUR, LIST_TOUR} TourStructure;
+
+
+// Memory reused between local searches, to avoid reallocations when solving many instances in a row.
+// Must be zero initialized, and freed with freeLocalSearchWorkspace().
+typedef struct
+{
+	int **population;
+	int *paths;
+	double *lengthArray;
+	double *currentLengthArray;
+	int *positions; // inverse of each path, used with candidate lists.
+	CityQueue *queues;
+	int *queuesCities;
+	char *queuesFlags;
+	TwoLevelList **lists; // created when first needed.
+	int populationCapacity;
+	int citiesCapacity;
+} LocalSearchWorkspace;
+
 
 // N.B: temperature seem better as floats (instead of doubles) for some reason...
 
-// Local search using 2-op heuristic. Returns the best found length:
-double localSearch(const void *context, const Map *map, int population_size, long epoch_number, localSearchMode mode);
+typedef struct
+{
+	float temperature; // Initial temperature, for SA and TA.
+	int verbose; // Printing the search results and the best found path.
+	int neighborhoods; // Bitwise OR of MoveType, e.g MOVE_2OPT | MOVE_OR_OPT. 0 for 2-opt moves only.
+	int *bestPath; // If not NULL, filled with the best found path.
+	LocalSearchWorkspace *workspace; // If not NULL, its memory is used instead of allocating a new one.
+	TourStructure tourStructure;
+	int threadsNumber; // The population is split between this many threads. 0 or 1 for a single threaded search.
+	InitMode initMode; // Initial paths, BIASED_RANDOM_INIT by default. Constructions are much shorter (see initPath()).
+
+	// Warm start: the first individuals start from copies of these paths (e.g read with readTour()), instead of
+	// random ones. Paths beyond the population size are ignored.
+	int **seedPaths;
+	int seedPathsNumber;
+
+	// Stopping conditions, checked at the end of each epoch:
+	double timeBudget; // In seconds, 0 for no limit.
+	double targetLength; // Stopping once a path this short is known, 0 for none.
+	double lowerBound; // Lower bound on the optimal length, e.g from heldKarpBound(). 0 if unknown.
+	double targetGap; // Stopping once the best path is within this relative gap of 'lowerBound', e.g 0.01.
+
+	// If not NULL, the best found path is published to it from time to time, and the incumbent length
+	// is also checked against 'targetLength'. Used to run several solvers concurrently.
+	Incumbent *incumbent;
+	int incumbentWriter;
+} LocalSearchSettings;
+
+
+// Local search using 2-opt, Or-opt and 3-opt moves. Returns the best found length. Settings can be NULL, for a verbose search.
+double localSearch(const LocalSearchSettings *settings, const Map *map, int population_size, long epoch_number,
+	localSearchMode mode);
+
+
+void freeLocalSearchWorkspace(LocalSearchWorkspace *workspace);
 
 
 #endif
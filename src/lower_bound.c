@@ -0,0 +1,1000 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "lower_bound.h"
+
+
+// Symmetric sparse graph, in compressed rows: the neighbors of a city are those from 'start[city]' to
+// 'start[city + 1]' excluded, each appearing once.
+typedef struct
+{
+	int *start;
+	int *neighbors;
+	num_dist *distances;
+} SparseGraph;
+
+
+// Minimum 1-tree: a spanning tree rooted at city 0, plus a second edge from the leaf 'special' to 'specialNeighbor'.
+typedef struct
+{
+	int *parents; // -1 for the root.
+	double *parentWeights; // penalized length of the edge to the parent.
+	int *order; // cities in the order they joined the tree, parents first.
+	int *degrees;
+	int special;
+	int specialNeighbor;
+	double specialWeight;
+	double value; // penalized length, minus twice the sum of the penalties: a lower bound.
+} OneTree;
+
+
+// Binary heap of the cities not in the tree yet, by key. Cities in the tree have the position -2:
+typedef struct
+{
+	int *cities;
+	int *positions; // -1 if out of the heap.
+	double *keys; // by city.
+	int size;
+} CityHeap;
+
+
+// Jump pointers over a tree, giving the longest edge on the path between two cities in logarithmic time. The depth of
+// the city a jump leads to only depends on the depth of the starting one.
+typedef struct
+{
+	int *depths;
+	int *jumps;
+	double *jumpWeights; // longest edge from a city to the city it jumps to.
+} TreeJumps;
+
+
+// Sorts the array in place, and returns the number of distinct values, which are moved first:
+static int sortUnique(int *array, int length)
+{
+	for (int i = 1; i < length; ++i)
+	{
+		const int value = array[i];
+		int j = i;
+
+		for (; j > 0 && array[j - 1] > value; --j)
+			array[j] = array[j - 1];
+
+		array[j] = value;
+	}
+
+	int unique_number = length > 0;
+
+	for (int i = 1; i < length; ++i)
+	{
+		if (array[i] != array[unique_number - 1])
+			array[unique_number++] = array[i];
+	}
+
+	return unique_number;
+}
+
+
+static void freeSparseGraph(SparseGraph *graph)
+{
+	free(graph -> start);
+	free(graph -> neighbors);
+	free(graph -> distances);
+}
+
+
+// Graph of the candidate edges of the map, in both directions, plus the edges given by 'links_number' arrays of
+// 'links', giving for each city the one it is linked to, or -1. The first array must hold the successors of the cities
+// along a tour: without a tour in the graph, the bound of its 1-trees would be unbounded. Returns 0 on memory error.
+static int createSparseGraph(const Map *map, const int *links, int links_number, SparseGraph *graph)
+{
+	const int cities_number = map -> CitiesNumber, candidates_number = map -> CandidatesNumber;
+
+	int *fill = (int*) malloc(cities_number * sizeof(int)); // next free position of each row.
+
+	*graph = (SparseGraph) {.start = (int*) calloc(cities_number + 1, sizeof(int))};
+
+	if (!fill || !graph -> start)
+	{
+		free(fill);
+		freeSparseGraph(graph);
+		return 0;
+	}
+
+	// Counting the edges of each city, then filling the rows:
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		graph -> start[city + 1] += candidates_number;
+
+		for (int k = 0; k < candidates_number; ++k)
+			++(graph -> start[getCandidates(map, city)[k] + 1]);
+
+		for (int r = 0; r < links_number; ++r)
+		{
+			const int linked = links[(size_t) r * cities_number + city];
+
+			if (linked >= 0)
+			{
+				++(graph -> start[city + 1]);
+				++(graph -> start[linked + 1]);
+			}
+		}
+	}
+
+	for (int city = 0; city < cities_number; ++city)
+		graph -> start[city + 1] += graph -> start[city];
+
+	const int edges_number = graph -> start[cities_number];
+
+	graph -> neighbors = (int*) malloc(edges_number * sizeof(int));
+	graph -> distances = (num_dist*) malloc(edges_number * sizeof(num_dist));
+
+	if (!graph -> neighbors || !graph -> distances)
+	{
+		free(fill);
+		freeSparseGraph(graph);
+		return 0;
+	}
+
+	memcpy(fill, graph -> start, cities_number * sizeof(int));
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		for (int k = 0; k < candidates_number; ++k)
+		{
+			const int candidate = getCandidates(map, city)[k];
+
+			graph -> neighbors[fill[city]++] = candidate;
+			graph -> neighbors[fill[candidate]++] = city;
+		}
+
+		for (int r = 0; r < links_number; ++r)
+		{
+			const int linked = links[(size_t) r * cities_number + city];
+
+			if (linked >= 0)
+			{
+				graph -> neighbors[fill[city]++] = linked;
+				graph -> neighbors[fill[linked]++] = city;
+			}
+		}
+	}
+
+	free(fill);
+
+	// Removing the edges found twice:
+
+	int row_end = 0, size = 0;
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		const int row_start = row_end;
+		row_end = graph -> start[city + 1];
+
+		graph -> start[city] = size;
+		size += sortUnique(graph -> neighbors + row_start, row_end - row_start);
+		memmove(graph -> neighbors + graph -> start[city], graph -> neighbors + row_start,
+			(size - graph -> start[city]) * sizeof(int));
+
+		for (int i = graph -> start[city]; i < size; ++i)
+			graph -> distances[i] = getDistance(map, city, graph -> neighbors[i]);
+	}
+
+	graph -> start[cities_number] = size;
+
+	return 1;
+}
+
+
+static void freeOneTree(OneTree *tree)
+{
+	free(tree -> parents);
+	free(tree -> parentWeights);
+	free(tree -> order);
+	free(tree -> degrees);
+}
+
+
+static int createOneTree(OneTree *tree, int cities_number)
+{
+	*tree = (OneTree)
+	{
+		.parents = (int*) malloc(cities_number * sizeof(int)),
+		.parentWeights = (double*) malloc(cities_number * sizeof(double)),
+		.order = (int*) malloc(cities_number * sizeof(int)),
+		.degrees = (int*) malloc(cities_number * sizeof(int))
+	};
+
+	if (!tree -> parents || !tree -> parentWeights || !tree -> order || !tree -> degrees)
+	{
+		freeOneTree(tree);
+		return 0;
+	}
+
+	return 1;
+}
+
+
+static void freeCityHeap(CityHeap *heap)
+{
+	free(heap -> cities);
+	free(heap -> positions);
+	free(heap -> keys);
+}
+
+
+static int createCityHeap(CityHeap *heap, int cities_number)
+{
+	*heap = (CityHeap)
+	{
+		.cities = (int*) malloc(cities_number * sizeof(int)),
+		.positions = (int*) malloc(cities_number * sizeof(int)),
+		.keys = (double*) malloc(cities_number * sizeof(double))
+	};
+
+	if (!heap -> cities || !heap -> positions || !heap -> keys)
+	{
+		freeCityHeap(heap);
+		return 0;
+	}
+
+	return 1;
+}
+
+
+static inline void placeCity(CityHeap *heap, int city, int position)
+{
+	heap -> cities[position] = city;
+	heap -> positions[city] = position;
+}
+
+
+// Lowers the key of the city, adding it to the heap if needed:
+static void decreaseKey(CityHeap *heap, int city, double key)
+{
+	int position = heap -> positions[city] >= 0 ? heap -> positions[city] : heap -> size++;
+
+	heap -> keys[city] = key;
+
+	while (position > 0 && heap -> keys[heap -> cities[(position - 1) / 2]] > key)
+	{
+		placeCity(heap, heap -> cities[(position - 1) / 2], position);
+		position = (position - 1) / 2;
+	}
+
+	placeCity(heap, city, position);
+}
+
+
+static int popMinimum(CityHeap *heap)
+{
+	const int min_city = heap -> cities[0];
+	const int city = heap -> cities[--(heap -> size)];
+	const double key = heap -> keys[city];
+
+	int position = 0;
+
+	while (2 * position + 1 < heap -> size)
+	{
+		int child = 2 * position + 1;
+
+		if (child + 1 < heap -> size && heap -> keys[heap -> cities[child + 1]] < heap -> keys[heap -> cities[child]])
+			++child;
+
+		if (heap -> keys[heap -> cities[child]] >= key)
+			break;
+
+		placeCity(heap, heap -> cities[child], position);
+		position = child;
+	}
+
+	if (heap -> size > 0)
+		placeCity(heap, city, position);
+
+	heap -> positions[min_city] = -2;
+
+	return min_city;
+}
+
+
+// Neighbor of a leaf in the spanning tree:
+static inline int treeNeighbor(const OneTree *tree, int leaf)
+{
+	return tree -> parents[leaf] >= 0 ? tree -> parents[leaf] : tree -> order[1];
+}
+
+
+// Minimum spanning tree of the sparse graph for the penalized distances, with Prim's algorithm. Returns its length.
+static double sparseSpanningTree(const SparseGraph *graph, int cities_number, const double *penalties,
+	CityHeap *heap, OneTree *tree)
+{
+	for (int city = 0; city < cities_number; ++city)
+	{
+		heap -> positions[city] = -1;
+		heap -> keys[city] = INFINITY;
+		tree -> parents[city] = -1;
+		tree -> degrees[city] = 0;
+	}
+
+	heap -> size = 0;
+	decreaseKey(heap, 0, 0.);
+
+	double length = 0.;
+
+	for (int i = 0; i < cities_number && heap -> size > 0; ++i) // the graph being connected, all cities are reached.
+	{
+		const int city = popMinimum(heap);
+
+		tree -> order[i] = city;
+		tree -> parentWeights[city] = heap -> keys[city];
+		length += heap -> keys[city];
+
+		if (tree -> parents[city] >= 0)
+		{
+			++(tree -> degrees[city]);
+			++(tree -> degrees[tree -> parents[city]]);
+		}
+
+		for (int e = graph -> start[city]; e < graph -> start[city + 1]; ++e)
+		{
+			const int neighbor = graph -> neighbors[e];
+
+			if (heap -> positions[neighbor] == -2)
+				continue;
+
+			const double weight = graph -> distances[e] + penalties[city] + penalties[neighbor];
+
+			if (weight < heap -> keys[neighbor])
+			{
+				tree -> parents[neighbor] = city;
+				decreaseKey(heap, neighbor, weight);
+			}
+		}
+	}
+
+	return length;
+}
+
+
+// Minimum spanning tree of the complete graph for the penalized distances, in quadratic time. Its length is saved
+// in 'length'. Returns 0 on memory error.
+static int denseSpanningTree(const Map *map, const double *penalties, OneTree *tree, double *length)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	double *keys = (double*) malloc(cities_number * sizeof(double));
+	int *remaining = (int*) malloc(cities_number * sizeof(int)); // cities not in the tree yet.
+
+	if (!keys || !remaining)
+	{
+		free(keys);
+		free(remaining);
+		return 0;
+	}
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		keys[city] = INFINITY;
+		remaining[city] = city;
+		tree -> parents[city] = -1;
+		tree -> degrees[city] = 0;
+	}
+
+	keys[0] = 0.;
+	*length = 0.;
+
+	int remaining_number = cities_number, next = 0;
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const int city = remaining[next];
+		remaining[next] = remaining[--remaining_number];
+
+		tree -> order[i] = city;
+		tree -> parentWeights[city] = keys[city];
+		*length += keys[city];
+
+		if (tree -> parents[city] >= 0)
+		{
+			++(tree -> degrees[city]);
+			++(tree -> degrees[tree -> parents[city]]);
+		}
+
+		// Updating the keys, while looking for the next city:
+		double min_key = INFINITY;
+
+		for (int r = 0; r < remaining_number; ++r)
+		{
+			const int other = remaining[r];
+			const double weight = getDistance(map, city, other) + penalties[city] + penalties[other];
+
+			if (weight < keys[other])
+			{
+				keys[other] = weight;
+				tree -> parents[other] = city;
+			}
+
+			if (keys[other] < min_key)
+			{
+				min_key = keys[other];
+				next = r;
+			}
+		}
+	}
+
+	free(keys);
+	free(remaining);
+
+	return 1;
+}
+
+
+// Saves in 'links' the successor of each city along a greedy tour. Returns 0 on memory error.
+static int tourLinks(const Map *map, int *links)
+{
+	int *path = (int*) malloc(map -> CitiesNumber * sizeof(int));
+
+	if (!path)
+		return 0;
+
+	initPath(map, NULL, path, GREEDY_EDGE_INIT);
+
+	for (int i = 0; i < map -> CitiesNumber; ++i)
+		links[path[i]] = path[(i + 1) % map -> CitiesNumber];
+
+	free(path);
+
+	return 1;
+}
+
+
+// Graph of the candidate edges and of those of a greedy tour, plus those of the spanning tree of the complete graph for
+// the given penalties if it can be computed in quadratic time, the spanning tree of the graph being then the same.
+// 'tree' is used as a buffer. Returns 0 on memory error.
+static int createTreeGraph(const Map *map, const double *penalties, OneTree *tree, SparseGraph *graph)
+{
+	const int cities_number = map -> CitiesNumber;
+	const int links_number = cities_number <= HK_EXACT_MAX_CITIES ? 2 : 1;
+
+	int *links = (int*) malloc((size_t) links_number * cities_number * sizeof(int));
+
+	double tree_length;
+	int success = links && tourLinks(map, links) && (links_number == 1
+		|| denseSpanningTree(map, penalties, tree, &tree_length));
+
+	if (success && links_number == 2)
+		memcpy(links + cities_number, tree -> parents, cities_number * sizeof(int));
+
+	success = success && createSparseGraph(map, links, links_number, graph);
+
+	free(links);
+
+	return success;
+}
+
+
+// Completes the spanning tree of the given length into a 1-tree, by adding a second edge to the leaf for which it is
+// the longest, and computes its value. Its edges are those of the graph, or all of them if 'graph' is NULL.
+static void completeOneTree(const Map *map, const SparseGraph *graph, const double *penalties, double tree_length,
+	OneTree *tree)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	tree -> special = -1;
+	tree -> specialWeight = -INFINITY;
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		if (tree -> degrees[city] != 1)
+			continue;
+
+		const int tree_neighbor = treeNeighbor(tree, city);
+		const int neighbors_number = graph ? graph -> start[city + 1] - graph -> start[city] : cities_number;
+
+		double min_weight = INFINITY;
+		int min_neighbor = -1;
+
+		for (int i = 0; i < neighbors_number; ++i)
+		{
+			const int neighbor = graph ? graph -> neighbors[graph -> start[city] + i] : i;
+
+			if (neighbor == city || neighbor == tree_neighbor)
+				continue;
+
+			const double dist = graph ? graph -> distances[graph -> start[city] + i] : getDistance(map, city, neighbor);
+			const double weight = dist + penalties[city] + penalties[neighbor];
+
+			if (weight < min_weight)
+			{
+				min_weight = weight;
+				min_neighbor = neighbor;
+			}
+		}
+
+		if (min_neighbor >= 0 && min_weight > tree -> specialWeight)
+		{
+			tree -> special = city;
+			tree -> specialNeighbor = min_neighbor;
+			tree -> specialWeight = min_weight;
+		}
+	}
+
+	++(tree -> degrees[tree -> special]);
+	++(tree -> degrees[tree -> specialNeighbor]);
+
+	double penalties_sum = 0.;
+
+	for (int city = 0; city < cities_number; ++city)
+		penalties_sum += penalties[city];
+
+	tree -> value = tree_length + tree -> specialWeight - 2. * penalties_sum;
+}
+
+
+// Evaluates the 1-tree of the sparse graph for the given penalties. Returns the squared norm of the subgradient,
+// i.e of the degrees minus 2, null if the 1-tree is a tour:
+static double evaluatePenalties(const Map *map, const SparseGraph *graph, const double *penalties, OneTree *tree,
+	CityHeap *heap)
+{
+	const double tree_length = sparseSpanningTree(graph, map -> CitiesNumber, penalties, heap, tree);
+	completeOneTree(map, graph, penalties, tree_length, tree);
+
+	double norm = 0.;
+
+	for (int city = 0; city < map -> CitiesNumber; ++city)
+		norm += (tree -> degrees[city] - 2) * (tree -> degrees[city] - 2);
+
+	return norm;
+}
+
+
+// Subgradient optimization of the penalties, starting from the given ones, as done by LKH: the penalty of each city
+// moves by the step size times its degree in the 1-tree minus 2, mixed with the previous direction. The step size
+// doubles while the bound improves at first, then it is halved with the number of iterations at the end of each period.
+// The best penalties are saved in 'penalties', and the best bound found on the sparse graph in 'bound'.
+// Returns 0 on memory error.
+static int ascent(const Map *map, const SparseGraph *graph, double *penalties, OneTree *tree, CityHeap *heap,
+	double *bound)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	double *current_penalties = (double*) malloc(cities_number * sizeof(double));
+	int *last_gradient = (int*) calloc(cities_number, sizeof(int));
+
+	if (!current_penalties || !last_gradient)
+	{
+		free(current_penalties);
+		free(last_gradient);
+		return 0;
+	}
+
+	memcpy(current_penalties, penalties, cities_number * sizeof(double));
+
+	double mean_distance = 0.;
+
+	for (int e = 0; e < graph -> start[cities_number]; ++e)
+		mean_distance += graph -> distances[e];
+
+	mean_distance /= graph -> start[cities_number];
+
+	const int initial_period = cities_number / 2 < HK_MIN_PERIOD ? HK_MIN_PERIOD :
+		cities_number / 2 > HK_MAX_PERIOD ? HK_MAX_PERIOD : cities_number / 2;
+
+	double norm = evaluatePenalties(map, graph, current_penalties, tree, heap);
+	double best_bound = tree -> value, step = HK_INITIAL_STEP * mean_distance;
+	const double min_step = HK_MIN_STEP * mean_distance;
+	int initial_phase = 1;
+
+	for (int period = initial_period; period > 0 && step >= min_step && norm != 0.; period /= 2, step /= 2.)
+	{
+		for (int p = 1; p <= period && norm != 0.; ++p)
+		{
+			for (int city = 0; city < cities_number; ++city)
+			{
+				const int gradient = tree -> degrees[city] - 2;
+
+				current_penalties[city] += step * (0.7 * gradient + 0.3 * last_gradient[city]);
+				last_gradient[city] = gradient;
+			}
+
+			norm = evaluatePenalties(map, graph, current_penalties, tree, heap);
+
+			if (tree -> value > best_bound)
+			{
+				best_bound = tree -> value;
+				memcpy(penalties, current_penalties, cities_number * sizeof(double));
+
+				if (initial_phase)
+					step *= 2.;
+
+				// Improving until the end of the period, which is then extended:
+				if (p == period)
+					period = 2 * period < initial_period ? 2 * period : initial_period;
+			}
+			else if (initial_phase && p > period / 2)
+			{
+				initial_phase = 0;
+				p = 0;
+				step *= 0.75;
+			}
+		}
+	}
+
+	free(current_penalties);
+	free(last_gradient);
+
+	*bound = best_bound;
+
+	return 1;
+}
+
+
+// Copies the candidate lists of the map in 'local_map', a copy of it, or builds temporary ones of 'candidates_number'
+// cities if it has less. The latter must then be freed if they differ from those of the map. Returns 0 on failure.
+static int localCandidates(const Map *map, Map *local_map, int candidates_number)
+{
+	if (map -> CandidatesNumber >= candidates_number)
+		return 1;
+
+	local_map -> Candidates = NULL;
+	local_map -> CandidatesDistances = NULL;
+	local_map -> CandidatesNumber = 0;
+	local_map -> Mapping = NULL;
+
+	return initCandidates(local_map, candidates_number);
+}
+
+
+// Held–Karp lower bound on the length of the tours of the map. 'penalties' (CitiesNumber values) can be NULL, else it
+// is filled with the penalties of the bound, e.g for initAlphaCandidates(). The bound is rounded up for maps whose
+// distances are integers. Returns 0 on memory error.
+double heldKarpBound(const Map *map, double *penalties)
+{
+	if (!map || map -> CitiesNumber < 3)
+	{
+		printf("\nInvalid argument in 'heldKarpBound()'.\n\n");
+		return 0.;
+	}
+
+	const int cities_number = map -> CitiesNumber;
+	const int candidates_number = HK_CANDIDATES < cities_number ? HK_CANDIDATES : cities_number - 1;
+	const int exact = cities_number <= HK_EXACT_MAX_CITIES;
+
+	Map local_map = *map;
+	SparseGraph graph = {0};
+	OneTree tree = {0};
+	CityHeap heap = {0};
+
+	double *best_penalties = penalties ? penalties : (double*) malloc(cities_number * sizeof(double));
+	double *current_penalties = (double*) calloc(cities_number, sizeof(double));
+	int *links = (int*) malloc((size_t) (exact ? HK_GRAPH_ROUNDS + 1 : 1) * cities_number * sizeof(int));
+
+	int success = best_penalties && current_penalties && links && localCandidates(map, &local_map, candidates_number)
+		&& createOneTree(&tree, cities_number) && createCityHeap(&heap, cities_number) && tourLinks(&local_map, links);
+
+	double bound = -INFINITY, sparse_bound = -INFINITY;
+
+	// Optimizations on the sparse graph, completed each time by the edges of the spanning tree of the complete graph,
+	// whose 1-tree gives a proven bound. Penalties may indeed make edges out of the graph the shortest ones. Stopping
+	// once the spanning tree is in the graph:
+	for (int round = 0; success; ++round)
+	{
+		if (exact)
+		{
+			double tree_length;
+
+			if (!(success = denseSpanningTree(map, current_penalties, &tree, &tree_length)))
+				break;
+
+			completeOneTree(map, NULL, current_penalties, tree_length, &tree);
+
+			if (tree.value > bound)
+			{
+				bound = tree.value;
+				memcpy(best_penalties, current_penalties, cities_number * sizeof(double));
+			}
+
+			if (round == HK_GRAPH_ROUNDS || (round > 0 && tree.value >= sparse_bound - 1e-9 * fabs(sparse_bound)))
+				break;
+
+			memcpy(links + (size_t) (round + 1) * cities_number, tree.parents, cities_number * sizeof(int));
+		}
+
+		if (!(success = createSparseGraph(&local_map, links, exact ? round + 2 : 1, &graph)))
+			break;
+
+		success = ascent(map, &graph, current_penalties, &tree, &heap, &sparse_bound);
+
+		freeSparseGraph(&graph);
+
+		if (!exact)
+		{
+			bound = sparse_bound;
+			memcpy(best_penalties, current_penalties, cities_number * sizeof(double));
+			break;
+		}
+	}
+
+	if (success && (map -> WeightType != EUC_2D || map -> Rounding == ROUNDED))
+		bound = ceil(bound - 1e-9 * bound);
+
+	if (!success)
+	{
+		printf("\nNot enough memory to compute the Held-Karp bound.\n");
+		bound = 0.;
+	}
+
+	if (local_map.Candidates != map -> Candidates)
+	{
+		free(local_map.Candidates);
+		free(local_map.CandidatesDistances);
+	}
+
+	freeOneTree(&tree);
+	freeCityHeap(&heap);
+	free(current_penalties);
+	free(links);
+
+	if (!penalties)
+		free(best_penalties);
+
+	return bound;
+}
+
+
+static void freeTreeJumps(TreeJumps *jumps)
+{
+	free(jumps -> depths);
+	free(jumps -> jumps);
+	free(jumps -> jumpWeights);
+}
+
+
+// Each city jumps either to its parent, or twice as far as its parent jumps, so that any ancestor is reached
+// in a logarithmic number of jumps. Returns 0 on memory error.
+static int createTreeJumps(TreeJumps *jumps, const OneTree *tree, int cities_number)
+{
+	*jumps = (TreeJumps)
+	{
+		.depths = (int*) malloc(cities_number * sizeof(int)),
+		.jumps = (int*) malloc(cities_number * sizeof(int)),
+		.jumpWeights = (double*) malloc(cities_number * sizeof(double))
+	};
+
+	if (!jumps -> depths || !jumps -> jumps || !jumps -> jumpWeights)
+	{
+		freeTreeJumps(jumps);
+		return 0;
+	}
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const int city = tree -> order[i], parent = tree -> parents[city];
+
+		if (parent < 0)
+		{
+			jumps -> depths[city] = 0;
+			jumps -> jumps[city] = city;
+			jumps -> jumpWeights[city] = -INFINITY;
+			continue;
+		}
+
+		const int parent_jump = jumps -> jumps[parent];
+
+		jumps -> depths[city] = jumps -> depths[parent] + 1;
+
+		if (jumps -> depths[parent] - jumps -> depths[parent_jump]
+			== jumps -> depths[parent_jump] - jumps -> depths[jumps -> jumps[parent_jump]])
+		{
+			jumps -> jumps[city] = jumps -> jumps[parent_jump];
+			jumps -> jumpWeights[city] = fmax(tree -> parentWeights[city],
+				fmax(jumps -> jumpWeights[parent], jumps -> jumpWeights[parent_jump]));
+		}
+		else
+		{
+			jumps -> jumps[city] = parent;
+			jumps -> jumpWeights[city] = tree -> parentWeights[city];
+		}
+	}
+
+	return 1;
+}
+
+
+// Longest edge on the path between the two cities in the tree:
+static double longestEdge(const TreeJumps *jumps, const OneTree *tree, int city_1, int city_2)
+{
+	double longest = -INFINITY;
+
+	if (jumps -> depths[city_1] < jumps -> depths[city_2])
+	{
+		const int temp = city_1;
+		city_1 = city_2;
+		city_2 = temp;
+	}
+
+	while (jumps -> depths[city_1] > jumps -> depths[city_2])
+	{
+		if (jumps -> depths[jumps -> jumps[city_1]] >= jumps -> depths[city_2])
+		{
+			longest = fmax(longest, jumps -> jumpWeights[city_1]);
+			city_1 = jumps -> jumps[city_1];
+		}
+		else
+		{
+			longest = fmax(longest, tree -> parentWeights[city_1]);
+			city_1 = tree -> parents[city_1];
+		}
+	}
+
+	// Same depths, hence jumps of same lengths:
+	while (city_1 != city_2)
+	{
+		if (jumps -> jumps[city_1] != jumps -> jumps[city_2])
+		{
+			longest = fmax(longest, fmax(jumps -> jumpWeights[city_1], jumps -> jumpWeights[city_2]));
+			city_1 = jumps -> jumps[city_1];
+			city_2 = jumps -> jumps[city_2];
+		}
+		else
+		{
+			longest = fmax(longest, fmax(tree -> parentWeights[city_1], tree -> parentWeights[city_2]));
+			city_1 = tree -> parents[city_1];
+			city_2 = tree -> parents[city_2];
+		}
+	}
+
+	return longest;
+}
+
+
+// Alpha-nearness of an edge: increase of the length of the 1-tree, when forced to contain it. The edge then replaces
+// the longest one on the path between its cities, or the second edge of the special leaf.
+static double alphaNearness(const TreeJumps *jumps, const OneTree *tree, int city_1, int city_2, double weight)
+{
+	if (tree -> parents[city_1] == city_2 || tree -> parents[city_2] == city_1)
+		return 0.;
+
+	if (city_1 == tree -> special || city_2 == tree -> special)
+	{
+		const int other = city_1 == tree -> special ? city_2 : city_1;
+
+		return other == tree -> specialNeighbor ? 0. : weight - tree -> specialWeight;
+	}
+
+	return weight - longestEdge(jumps, tree, city_1, city_2);
+}
+
+
+// Replaces the candidate lists of the map by the 'candidates_number' cities of lowest alpha-nearness to each city,
+// i.e whose edge makes the 1-tree of the given penalties (see heldKarpBound()) grow the least. Those are picked among
+// the HK_CANDIDATES nearest cities, or more if 'candidates_number' is greater, and sorted by distance as the local
+// searches expect. Runs heldKarpBound() if 'penalties' is NULL. Returns 0 on failure.
+int initAlphaCandidates(Map *map, int candidates_number, const double *penalties)
+{
+	if (!map || map -> CitiesNumber < 3 || candidates_number < 1 || candidates_number >= map -> CitiesNumber)
+	{
+		printf("\nInvalid argument in 'initAlphaCandidates()'.\n\n");
+		return 0;
+	}
+
+	const int cities_number = map -> CitiesNumber;
+
+	int graph_candidates = HK_CANDIDATES > candidates_number ? HK_CANDIDATES : candidates_number;
+	graph_candidates = graph_candidates < cities_number ? graph_candidates : cities_number - 1;
+
+	double *own_penalties = NULL;
+
+	if (!penalties)
+	{
+		own_penalties = (double*) malloc(cities_number * sizeof(double));
+
+		if (!own_penalties || heldKarpBound(map, own_penalties) == 0.)
+		{
+			free(own_penalties);
+			return 0;
+		}
+
+		penalties = own_penalties;
+	}
+
+	Map local_map = *map;
+	SparseGraph graph = {0};
+	OneTree tree = {0};
+	CityHeap heap = {0};
+	TreeJumps jumps = {0};
+
+	int *candidates = (int*) malloc((size_t) cities_number * candidates_number * sizeof(int));
+	num_dist *distances = (num_dist*) malloc((size_t) cities_number * candidates_number * sizeof(num_dist));
+	double *alphas = (double*) malloc(candidates_number * sizeof(double)); // of the best edges of a city so far.
+
+	int success = candidates && distances && alphas && localCandidates(map, &local_map, graph_candidates)
+		&& createOneTree(&tree, cities_number) && createTreeGraph(&local_map, penalties, &tree, &graph)
+		&& createCityHeap(&heap, cities_number);
+
+	if (success)
+	{
+		const double tree_length = sparseSpanningTree(&graph, cities_number, penalties, &heap, &tree);
+		completeOneTree(map, &graph, penalties, tree_length, &tree);
+
+		success = createTreeJumps(&jumps, &tree, cities_number);
+	}
+
+	for (int city = 0; success && city < cities_number; ++city)
+	{
+		int *city_candidates = candidates + (size_t) city * candidates_number;
+		num_dist *city_distances = distances + (size_t) city * candidates_number;
+		int selected_number = 0;
+
+		// Keeping the edges of lowest alpha-nearness, then of lowest distance, by insertion:
+		for (int e = graph.start[city]; e < graph.start[city + 1]; ++e)
+		{
+			const int neighbor = graph.neighbors[e];
+			const num_dist dist = graph.distances[e];
+			const double alpha = alphaNearness(&jumps, &tree, city, neighbor, dist + penalties[city] + penalties[neighbor]);
+
+			int i = selected_number < candidates_number ? selected_number++ : candidates_number;
+
+			for (; i > 0 && (alphas[i - 1] > alpha || (alphas[i - 1] == alpha && city_distances[i - 1] > dist)); --i)
+			{
+				if (i < candidates_number)
+				{
+					alphas[i] = alphas[i - 1];
+					city_candidates[i] = city_candidates[i - 1];
+					city_distances[i] = city_distances[i - 1];
+				}
+			}
+
+			if (i < candidates_number)
+			{
+				alphas[i] = alpha;
+				city_candidates[i] = neighbor;
+				city_distances[i] = dist;
+			}
+		}
+
+		// Sorted by distance:
+		for (int i = 1; i < candidates_number; ++i)
+		{
+			const int candidate = city_candidates[i];
+			const num_dist dist = city_distances[i];
+			int j = i;
+
+			for (; j > 0 && city_distances[j - 1] > dist; --j)
+			{
+				city_candidates[j] = city_candidates[j - 1];
+				city_distances[j] = city_distances[j - 1];
+			}
+
+			city_candidates[j] = candidate;
+			city_distances[j] = dist;
+		}
+	}
+
+	if (local_map.Candidates != map -> Candidates)
+	{
+		free(local_map.Candidates);
+		free(local_map.CandidatesDistances);
+	}
+
+	freeSparseGraph(&graph);
+	freeOneTree(&tree);
+	freeCityHeap(&heap);
+	freeTreeJumps(&jumps);
+	free(own_penalties);
+	free(alphas);
+
+	if (!success)
+	{
+		printf("\nNot enough memory to build alpha-nearness candidate lists.\n");
+		free(candidates);
+		free(distances);
+		return 0;
+	}
+
+	setCandidates(map, candidates, distances, candidates_number);
+
+	return 1;
+}
@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////
+// Held–Karp lower bound on the length of the optimal tour, found by subgradient optimization of 1-trees, whose edges
+// are penalized at each city (the 'penalties', pi), and alpha-nearness candidate lists obtained as a by-product.
+// Knowing a bound, searches can stop once their best path is close enough to the optimum: see 'lowerBound' and
+// 'targetGap' in LocalSearchSettings, and 'targetFitness' of species for genetic searches.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef LOWER_BOUND_H
+#define LOWER_BOUND_H
+
+
+#include "salesman.h"
+
+
+#define HK_CANDIDATES 10 // nearest neighbors making up the sparse graph on which the 1-trees are computed.
+#define HK_INITIAL_STEP 0.01 // initial step size of the optimization, relative to the mean length of these edges.
+#define HK_MIN_STEP 0.0001 // the optimization stops once the step size falls below this, relative as well.
+#define HK_MIN_PERIOD 100 // iterations of the first period of the optimization: half the number of cities,
+#define HK_MAX_PERIOD 1000 // within these bounds. The next periods are halved.
+
+// Up to this many cities, 1-trees are also computed on the complete graph, in quadratic time, so that the bound is
+// proven. Their edges are added to the sparse graph, and the optimization carried on, up to HK_GRAPH_ROUNDS times.
+// Beyond, the bound is only computed on the sparse graph: it is then close, but may exceed the true one.
+#define HK_EXACT_MAX_CITIES 20000
+#define HK_GRAPH_ROUNDS 5
+
+
+// Held–Karp lower bound on the length of the tours of the map. 'penalties' (CitiesNumber values) can be NULL, else it
+// is filled with the penalties of the bound, e.g for initAlphaCandidates(). The bound is rounded up for maps whose
+// distances are integers. Returns 0 on memory error.
+double heldKarpBound(const Map *map, double *penalties);
+
+
+// Replaces the candidate lists of the map by the 'candidates_number' cities of lowest alpha-nearness to each city,
+// i.e whose edge makes the 1-tree of the given penalties (see heldKarpBound()) grow the least. Those are picked among
+// the HK_CANDIDATES nearest cities, or more if 'candidates_number' is greater, and sorted by distance as the local
+// searches expect. Runs heldKarpBound() if 'penalties' is NULL. Returns 0 on failure.
+int initAlphaCandidates(Map *map, int candidates_number, const double *penalties);
+
+
+// Relative gap between the given length and lower bound, e.g 0.01 for a length 1% above the bound:
+static inline double optimalityGap(double length, double lower_bound)
+{
+	return lower_bound > 0. ? length / lower_bound - 1. : INFINITY;
+}
+
+
+#endif
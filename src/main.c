@@ -1,5 +1,9 @@
+#define _POSIX_C_SOURCE 200809L // for fork().
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "GenLib.h"
 #include "sinus_example.h"
@@ -7,9 +11,20 @@
 #include "sales_gen.h"
 #include "driver_TSPLIB.h"
 #include "local_search.h"
+#include "scheduler.h"
+#include "islands.h"
+#include "portfolio.h"
+#include "map_cache.h"
+#include "lower_bound.h"
 
 
 void test_TSP(void);
+void test_scheduler(void);
+void test_islands(void);
+void test_portfolio(void);
+void test_map_cache(void);
+void test_warm_start(void);
+void test_lower_bound(void);
 
 
 int main(void)
@@ -24,6 +39,30 @@ int main(void)
 
 	///////////////////////////////////////////////////////
 
+	// test_scheduler();
+
+	///////////////////////////////////////////////////////
+
+	// test_islands();
+
+	///////////////////////////////////////////////////////
+
+	// test_portfolio();
+
+	///////////////////////////////////////////////////////
+
+	// test_map_cache();
+
+	///////////////////////////////////////////////////////
+
+	// test_warm_start();
+
+	///////////////////////////////////////////////////////
+
+	// test_lower_bound();
+
+	///////////////////////////////////////////////////////
+
 	return 0;
 }
 
@@ -50,9 +89,18 @@ void test_TSP(void)
 	localSearch(NULL, map, 2 * population_size, 5.7 * epoch_number, STOCHASTIC);
 	localSearch(NULL, map, 2 * population_size, 1 * epoch_number, GREEDY);
 
-	float temperature = 0.1f;
-	localSearch(&temperature, map, 1 * population_size, 3 * epoch_number, SA);
-	localSearch(&temperature, map, 1 * population_size, 4 * epoch_number, TA);
+	LocalSearchSettings settings = {.temperature = 0.1f, .verbose = 1};
+	localSearch(&settings, map, 1 * population_size, 3 * epoch_number, SA);
+	localSearch(&settings, map, 1 * population_size, 4 * epoch_number, TA);
+
+	initCandidates(map, 10); // used by the local searches, and by the EAX crossover.
+	LocalSearchSettings lk_settings = {.verbose = 1, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT, .threadsNumber = 4};
+	localSearch(&lk_settings, map, 16, epoch_number, LIN_KERNIGHAN);
+
+	// Starting from randomized greedy paths instead of random ones:
+	LocalSearchSettings greedy_settings = {.verbose = 1, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT,
+		.initMode = GREEDY_EDGE_INIT};
+	localSearch(&greedy_settings, map, 16, epoch_number, TWO_OPT);
 
 	// // For a280:
 	// int population_size = 256;
@@ -61,9 +109,9 @@ void test_TSP(void)
 	// localSearch(NULL, map, 2. * population_size, 12 * epoch_number, STOCHASTIC);
 	// localSearch(NULL, map, population_size, 0.004 * epoch_number, GREEDY);
 
-	// float temperature = 1.5f;
-	// localSearch(&temperature, map, 0.5 * population_size, 6 * epoch_number, SA);
-	// localSearch(&temperature, map, 0.5 * population_size, 10 * epoch_number, TA);
+	// LocalSearchSettings settings = {.temperature = 1.5f, .verbose = 1};
+	// localSearch(&settings, map, 0.5 * population_size, 6 * epoch_number, SA);
+	// localSearch(&settings, map, 0.5 * population_size, 10 * epoch_number, TA);
 
 	///////////////////////////////////////////////////////
 	// Genetic search without crossover:
@@ -74,7 +122,7 @@ void test_TSP(void)
 
 	double found_length_1 = pathLength(map, species_1 -> geneBuffer);
 
-	printPath(species_1 -> geneBuffer, map -> CitiesNumber);
+	printPath(map, species_1 -> geneBuffer);
 	printf("\nShortest found path: %.3f km\n", found_length_1);
 
 	destroySpecies(&species_1);
@@ -88,26 +136,239 @@ void test_TSP(void)
 
 	double found_length_2 = pathLength(map, species_2 -> geneBuffer);
 
-	printPath(species_2 -> geneBuffer, map -> CitiesNumber);
+	printPath(map, species_2 -> geneBuffer);
 	printf("\nShortest found path: %.3f km\n", found_length_2);
 
 	destroySpecies(&species_2);
 
 	///////////////////////////////////////////////////////
-	// // Genetic search with crossover 3 - very slow:
+	// Genetic search with crossover 3 (see also GeneMeth_salesman_4 to 6, for OX, PMX and CX crossovers):
 
-	// Species *species_3 = createSpecies(&GeneMeth_salesman_3, map, population_size);
+	Species *species_3 = createSpecies(&GeneMeth_salesman_3, map, population_size);
 
-	// geneticSearch(species_3, 0.5 * epoch_number);
+	geneticSearch(species_3, 0.5 * epoch_number);
 
-	// double found_length_3 = pathLength(map, species_3 -> geneBuffer);
+	double found_length_3 = pathLength(map, species_3 -> geneBuffer);
 
-	// printPath(species_3 -> geneBuffer, map -> CitiesNumber);
-	// printf("\nShortest found path: %.3f km\n", found_length_3);
+	printPath(map, species_3 -> geneBuffer);
+	printf("\nShortest found path: %.3f km\n", found_length_3);
 
-	// destroySpecies(&species_3);
+	destroySpecies(&species_3);
 
 	///////////////////////////////////////////////////////
+	// Genetic search with the EAX crossover, using the candidate lists built above:
+
+	Species *species_7 = createSpecies(&GeneMeth_salesman_7, map, population_size);
+
+	geneticSearch(species_7, 0.01 * epoch_number);
+
+	double found_length_7 = pathLength(map, species_7 -> geneBuffer);
+
+	printPath(map, species_7 -> geneBuffer);
+	printf("\nShortest found path: %.3f km\n", found_length_7);
+
+	destroySpecies(&species_7);
+
+	///////////////////////////////////////////////////////
+
+	freeMap(&map);
+}
+
+
+// Solving many small instances concurrently:
+void test_scheduler(void)
+{
+	const int threads_number = 4, jobs_number = 1000, cities_number = 50;
+
+	Map *map = createMap(cities_number, RANDOM, EXACT);
+
+	Scheduler *scheduler = createScheduler(threads_number);
+
+	SolverJob *jobs = (SolverJob*) calloc(jobs_number, sizeof(SolverJob));
+
+	for (int i = 0; i < jobs_number; ++i)
+	{
+		jobs[i].map = map;
+		jobs[i].type = i % 2 ? GENETIC_JOB : LOCAL_SEARCH_JOB;
+		jobs[i].genMeth = &GeneMeth_salesman_1;
+		jobs[i].mode = STOCHASTIC;
+		jobs[i].populationSize = 32;
+		jobs[i].epochNumber = 10000L * cities_number;
+
+		submitJob(scheduler, jobs + i);
+	}
+
+	waitJobs(scheduler);
+
+	double mean_latency = 0., max_latency = 0.;
+
+	for (int i = 0; i < jobs_number; ++i)
+	{
+		mean_latency += jobs[i].latency / jobs_number;
+
+		if (jobs[i].latency > max_latency)
+			max_latency = jobs[i].latency;
+	}
+
+	printf("\n%d jobs done. Mean latency: %.3f s, max latency: %.3f s\n", jobs_number, mean_latency, max_latency);
+
+	free(jobs);
+	destroyScheduler(&scheduler);
+	freeMap(&map);
+}
+
+
+// Genetic searches in several processes, exchanging their best genes:
+void test_islands(void)
+{
+	const int processes_number = 4, migrations_number = 100;
+
+	Map *map = getMapFromDataset("datasets/berlin52.tsp", ROUNDED);
+
+	const size_t gene_size = salesmanGeneSize(map);
+	long epoch_number = 1000L * map -> CitiesNumber;
+
+	for (int p = 0; p < processes_number; ++p)
+	{
+		if (fork() != 0)
+			continue;
+
+		Archipelago *archipelago = joinArchipelago("/genlib_berlin52", gene_size, 32);
+		Species *species = createSpecies(&GeneMeth_salesman_1, map, 64);
+
+		for (int m = 0; archipelago && species && m < migrations_number; ++m)
+		{
+			geneticStep(species, epoch_number);
+			migrate(archipelago, species);
+		}
+
+		destroySpecies(&species);
+		leaveArchipelago(&archipelago, 0);
+		freeMap(&map);
+		exit(EXIT_SUCCESS);
+	}
+
+	while (wait(NULL) > 0);
+
+	// Reading the group best, which has been kept in shared memory:
+
+	Archipelago *archipelago = joinArchipelago("/genlib_berlin52", gene_size, 32);
+	Species *species = createSpecies(&GeneMeth_salesman_1, map, 1); // only used for its genetic methods.
+
+	if (archipelago && species && getGroupBest(archipelago, species, species -> geneBuffer) > 0.)
+	{
+		printPath(map, species -> geneBuffer);
+		printf("\nShortest found path: %.3f km\n", pathLength(map, species -> geneBuffer));
+	}
+
+	destroySpecies(&species);
+	leaveArchipelago(&archipelago, 1);
+	freeMap(&map);
+}
+
+
+// Running all solvers concurrently, until the optimal length of berlin52 is found:
+void test_portfolio(void)
+{
+	Map *map = getMapFromDataset("datasets/berlin52.tsp", ROUNDED);
+
+	PortfolioSettings settings = {.timeBudget = 10., .targetLength = 7542., .temperature = 0.1f,
+		.populationSize = 256, .verbose = 1};
+
+	portfolioSearch(&settings, map, NULL);
+
+	freeMap(&map);
+}
+
+
+// Loading a map from its binary cache, written on the first run:
+void test_map_cache(void)
+{
+	Map *map = getCachedMap("datasets/a280.tsp", "datasets/a280.map", ROUNDED, 10);
+
+	if (!map)
+		return;
+
+	LocalSearchSettings settings = {.verbose = 1, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT};
+	localSearch(&settings, map, 16, 1L << 40, LIN_KERNIGHAN);
+
+	freeMap(&map);
+}
+
+
+// Saving the best found tour, then starting the local and genetic searches from it:
+void test_warm_start(void)
+{
+	Map *map = getMapFromDataset("datasets/a280.tsp", ROUNDED);
+	initCandidates(map, 10);
+
+	int *best_path = (int*) malloc(map -> CitiesNumber * sizeof(int));
+
+	LocalSearchSettings settings = {.verbose = 0, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT, .bestPath = best_path};
+	localSearch(&settings, map, 1, 1L << 40, LIN_KERNIGHAN);
+
+	writeTour("datasets/a280.tour", "a280", map, best_path);
+	free(best_path);
+
+	int *seed_path = readTour("datasets/a280.tour", map);
+
+	if (!seed_path)
+	{
+		freeMap(&map);
+		return;
+	}
+
+	settings = (LocalSearchSettings) {.verbose = 1, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT,
+		.seedPaths = &seed_path, .seedPathsNumber = 1};
+
+	localSearch(&settings, map, 1, 1L << 40, LIN_KERNIGHAN);
+
+	Species *species = createSalesmanSpecies(&GeneMeth_salesman_7, map, 100, &seed_path, 1);
+	geneticSearch(species, 10000);
+
+	printf("\nShortest found path: %.3f\n", pathLength(map, species -> geneBuffer));
+
+	destroySpecies(&species);
+	free(seed_path);
+	freeMap(&map);
+}
+
+
+// Held–Karp bound, alpha-nearness candidates, and searches stopping within 5% of the bound:
+void test_lower_bound(void)
+{
+	Map *map = getMapFromDataset("datasets/a280.tsp", ROUNDED);
+
+	double *penalties = (double*) malloc(map -> CitiesNumber * sizeof(double));
+	const double lower_bound = heldKarpBound(map, penalties), target_gap = 0.05;
+
+	printf("\nHeld-Karp bound: %.3f\n", lower_bound);
+
+	if (!penalties || lower_bound <= 0. || !initAlphaCandidates(map, 5, penalties))
+	{
+		free(penalties);
+		freeMap(&map);
+		return;
+	}
+
+	LocalSearchSettings settings = {.verbose = 1, .neighborhoods = MOVE_2OPT | MOVE_OR_OPT,
+		.lowerBound = lower_bound, .targetGap = target_gap};
+
+	localSearch(&settings, map, 16, 1L << 40, LIN_KERNIGHAN);
+
+	Species *species = createSpecies(&GeneMeth_salesman_7, map, 100);
+
+	if (species)
+	{
+		species -> targetFitness = salesmanFitness(lower_bound * (1. + target_gap));
+		geneticSearch(species, 100000);
+
+		const double length = pathLength(map, species -> geneBuffer);
+		printf("Shortest found path: %.3f, gap: %.3f %%\n", length, 100. * optimalityGap(length, lower_bound));
+
+		destroySpecies(&species);
+	}
 
+	free(penalties);
 	freeMap(&map);
 }
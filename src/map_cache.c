@@ -0,0 +1,336 @@
+#define _POSIX_C_SOURCE 200809L // for mmap(), fstat() and rename().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "map_cache.h"
+#include "driver_TSPLIB.h"
+
+
+#define MAP_CACHE_MAGIC 0x6863614370614d47ULL // "GMapCach"
+#define MAP_CACHE_VERSION 3
+#define CACHE_LINE 64
+
+
+// File layout: this header, then the x and y locations, the matrix (rows padded to 'netStride' values, or packed,
+// followed by a cache line for vectorized gathers), the candidates and their distances, and the original numbers
+// of renumbered cities. Each block is aligned on cache lines, and absent ones have a null offset.
+typedef struct
+{
+	uint64_t magic;
+	uint32_t version;
+	uint32_t numMapSize; // sizeof(num_map)
+	uint32_t numDistSize; // sizeof(num_dist)
+	uint32_t distStorage; // DIST_STORAGE
+	int32_t citiesNumber;
+	int32_t netStride;
+	int32_t rounding;
+	int32_t weightType;
+	int32_t candidatesNumber;
+	int32_t triangularNet; // TRIANGULAR_NET
+	uint64_t datasetSize; // size and modification time of the source dataset, 0 if unknown.
+	int64_t datasetTime;
+	uint64_t locationsOffset[2];
+	uint64_t netOffset;
+	uint64_t candidatesOffset;
+	uint64_t candidatesDistancesOffset;
+	uint64_t originalCitiesOffset;
+	uint64_t fileSize;
+} MapCacheHeader;
+
+
+static inline uint64_t alignOffset(uint64_t offset)
+{
+	return (offset + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+}
+
+
+// Writes the block at the current offset, padded with zeros up to the next cache line. Returns 0 on failure.
+static int writeBlock(FILE *file, const void *data, size_t size, uint64_t *offset)
+{
+	static const char zeros[CACHE_LINE] = {0};
+
+	const size_t padding = alignOffset(*offset + size) - (*offset + size);
+
+	if (fwrite(data, 1, size, file) != size || fwrite(zeros, 1, padding, file) != padding)
+		return 0;
+
+	*offset += size + padding;
+
+	return 1;
+}
+
+
+static int writeCache(const Map *map, const char *filename, const struct stat *dataset_stat)
+{
+	const int cities_number = map -> CitiesNumber;
+
+	MapCacheHeader header =
+	{
+		.magic = MAP_CACHE_MAGIC,
+		.version = MAP_CACHE_VERSION,
+		.numMapSize = sizeof(num_map),
+		.numDistSize = sizeof(num_dist),
+		.distStorage = DIST_STORAGE,
+		.triangularNet = TRIANGULAR_NET,
+		.citiesNumber = cities_number,
+		.netStride = map -> Net ? map -> NetStride : 0,
+		.rounding = map -> Rounding,
+		.weightType = map -> WeightType,
+		.candidatesNumber = map -> Candidates ? map -> CandidatesNumber : 0,
+		.datasetSize = dataset_stat ? (uint64_t) dataset_stat -> st_size : 0,
+		.datasetTime = dataset_stat ? (int64_t) dataset_stat -> st_mtime : 0
+	};
+
+	const size_t locations_size = (size_t) cities_number * sizeof(num_map);
+	const size_t net_size = map -> Net ? netSize(map) * sizeof(num_dist) : 0;
+	const size_t candidates_number = (size_t) cities_number * header.candidatesNumber;
+
+	uint64_t offset = alignOffset(sizeof(MapCacheHeader));
+
+	for (int i = 0; i < 2; ++i)
+	{
+		header.locationsOffset[i] = offset;
+		offset = alignOffset(offset + locations_size);
+	}
+
+	if (map -> Net)
+	{
+		header.netOffset = offset;
+		offset = alignOffset(offset + net_size) + CACHE_LINE;
+	}
+
+	if (candidates_number)
+	{
+		header.candidatesOffset = offset;
+		offset = alignOffset(offset + candidates_number * sizeof(int));
+		header.candidatesDistancesOffset = offset;
+		offset = alignOffset(offset + candidates_number * sizeof(num_dist));
+	}
+
+	if (map -> OriginalCities)
+	{
+		header.originalCitiesOffset = offset;
+		offset = alignOffset(offset + cities_number * sizeof(int));
+	}
+
+	header.fileSize = offset;
+
+	// Written aside, then renamed:
+
+	char *temp_name = (char*) malloc(strlen(filename) + 32);
+
+	if (!temp_name)
+		return 0;
+
+	sprintf(temp_name, "%s.%ld.tmp", filename, (long) getpid());
+
+	FILE *file = fopen(temp_name, "wb");
+
+	if (!file)
+	{
+		free(temp_name);
+		return 0;
+	}
+
+	static const char zeros[CACHE_LINE] = {0};
+
+	uint64_t written = 0;
+	int success = writeBlock(file, &header, sizeof(MapCacheHeader), &written);
+
+	for (int i = 0; success && i < 2; ++i)
+		success = writeBlock(file, map -> Locations[i], locations_size, &written);
+
+	if (success && map -> Net)
+		success = writeBlock(file, map -> Net, net_size, &written) && writeBlock(file, zeros, CACHE_LINE, &written);
+
+	if (success && candidates_number)
+		success = writeBlock(file, map -> Candidates, candidates_number * sizeof(int), &written)
+			&& writeBlock(file, map -> CandidatesDistances, candidates_number * sizeof(num_dist), &written);
+
+	if (success && map -> OriginalCities)
+		success = writeBlock(file, map -> OriginalCities, cities_number * sizeof(int), &written);
+
+	success &= written == header.fileSize;
+	success &= fclose(file) == 0;
+	success = success && rename(temp_name, filename) == 0;
+
+	if (!success)
+		remove(temp_name);
+
+	free(temp_name);
+
+	return success;
+}
+
+
+// Writes the map, with its matrix and candidate lists if any, in the given cache file. The file is replaced
+// atomically, so that other processes never open a partial cache. Returns 0 on failure.
+int saveMapCache(const Map *map, const char *filename)
+{
+	if (!map || !filename)
+	{
+		printf("\nInvalid argument in 'saveMapCache()'.\n\n");
+		return 0;
+	}
+
+	if (!writeCache(map, filename, NULL))
+	{
+		printf("\nCould not write the map cache '%s'.\n", filename);
+		return 0;
+	}
+
+	return 1;
+}
+
+
+// Opens the cache silently, refusing it if it doesn't match the given dataset, when not NULL:
+static Map* mapCache(const char *filename, const struct stat *dataset_stat, DistanceRounding distMode,
+	int candidates_number)
+{
+	int fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+		return NULL;
+
+	struct stat file_stat;
+
+	if (fstat(fd, &file_stat) != 0 || (size_t) file_stat.st_size < sizeof(MapCacheHeader))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	const size_t file_size = file_stat.st_size;
+	char *data = (char*) mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return NULL;
+
+	const MapCacheHeader *header = (const MapCacheHeader*) data;
+
+	int valid = header -> magic == MAP_CACHE_MAGIC && header -> version == MAP_CACHE_VERSION
+		&& header -> numMapSize == sizeof(num_map) && header -> numDistSize == sizeof(num_dist)
+		&& header -> distStorage == DIST_STORAGE && header -> triangularNet == TRIANGULAR_NET
+		&& header -> fileSize == file_size && header -> citiesNumber > 0;
+
+	if (valid && dataset_stat)
+		valid = header -> datasetSize == (uint64_t) dataset_stat -> st_size
+			&& header -> datasetTime == (int64_t) dataset_stat -> st_mtime
+			&& header -> candidatesNumber == candidates_number
+			&& (header -> weightType != EUC_2D || header -> rounding == (int32_t) distMode)
+			&& (header -> originalCitiesOffset != 0) == (header -> weightType != EXPLICIT && RENUMBERING_MIN_CITIES > 0
+				&& header -> citiesNumber >= RENUMBERING_MIN_CITIES);
+
+	Map *map = valid ? (Map*) calloc(1, sizeof(Map)) : NULL;
+	num_map **locations = map ? (num_map**) calloc(2, sizeof(num_map*)) : NULL;
+
+	if (!locations)
+	{
+		free(map);
+		munmap(data, file_size);
+		return NULL;
+	}
+
+	*(int*) &(map -> CitiesNumber) = header -> citiesNumber;
+
+	locations[0] = (num_map*) (data + header -> locationsOffset[0]);
+	locations[1] = (num_map*) (data + header -> locationsOffset[1]);
+
+	map -> Locations = locations;
+	map -> Net = header -> netOffset ? (num_dist*) (data + header -> netOffset) : NULL;
+	map -> NetStride = header -> netStride;
+	map -> Rounding = (DistanceRounding) header -> rounding;
+	map -> WeightType = (EdgeWeightType) header -> weightType;
+
+	if (header -> candidatesNumber)
+	{
+		map -> CandidatesNumber = header -> candidatesNumber;
+		map -> Candidates = (int*) (data + header -> candidatesOffset);
+		map -> CandidatesDistances = (num_dist*) (data + header -> candidatesDistancesOffset);
+	}
+
+	if (header -> originalCitiesOffset)
+		map -> OriginalCities = (int*) (data + header -> originalCitiesOffset);
+
+	map -> Mapping = data;
+	map -> MappingSize = file_size;
+
+	return map;
+}
+
+
+// Maps the given cache file read-only, and returns a map using its memory, to be freed with freeMap(). Candidate
+// lists can still be built again with initCandidates(), but initMap() must not be called. Returns NULL on failure.
+Map* openMapCache(const char *filename)
+{
+	if (!filename)
+	{
+		printf("\nInvalid argument in 'openMapCache()'.\n\n");
+		return NULL;
+	}
+
+	Map *map = mapCache(filename, NULL, EXACT, 0);
+
+	if (!map)
+		printf("\nCould not open the map cache '%s'.\n", filename);
+
+	return map;
+}
+
+
+// Opens the cache of the given TSPLIB dataset if it is up to date, and has been built with the same rounding,
+// numbering and number of candidates (0 for none). Else the dataset is loaded, and its cache written for the next times.
+// Exits if the dataset can't be loaded, as getMapFromDataset() does.
+Map* getCachedMap(const char *dataset, const char *cache, DistanceRounding distMode, int candidates_number)
+{
+	if (!dataset || !cache || candidates_number < 0)
+	{
+		printf("\nInvalid argument in 'getCachedMap()'.\n\n");
+		return NULL;
+	}
+
+	struct stat dataset_stat;
+
+	if (stat(dataset, &dataset_stat) != 0)
+	{
+		printf("\nFile '%s' not found.\n", dataset);
+		exit(EXIT_FAILURE);
+	}
+
+	Map *map = mapCache(cache, &dataset_stat, distMode, candidates_number);
+
+	if (map)
+		return map;
+
+	map = getMapFromDataset(dataset, distMode);
+
+	if (candidates_number > 0 && !initCandidates(map, candidates_number))
+	{
+		freeMap(&map);
+		return NULL;
+	}
+
+	// Opened again from the cache, so that the map is shared and read-only the first time too:
+	if (!writeCache(map, cache, &dataset_stat))
+	{
+		printf("\nCould not write the map cache '%s'.\n", cache);
+		return map;
+	}
+
+	Map *cached_map = mapCache(cache, &dataset_stat, distMode, candidates_number);
+
+	if (!cached_map)
+		return map;
+
+	freeMap(&map);
+
+	return cached_map;
+}
@@ -0,0 +1,33 @@
+////////////////////////////////////////////////////////////////////////////////
+// Binary map cache: a map is written once with its locations, distance matrix, candidate lists and numbering,
+// then opened with mmap() instead of parsing its dataset and computing its distances again. Opened maps are read-only,
+// and processes opening the same cache share its memory through the page cache.
+//
+// Caches are tied to the storage types of salesman.h (num_map, num_dist), to the matrix layout (TRIANGULAR_NET)
+// and to the format version, and are refused if any differs.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+
+#include "salesman.h"
+
+
+// Writes the map, with its matrix and candidate lists if any, in the given cache file. The file is replaced
+// atomically, so that other processes never open a partial cache. Returns 0 on failure.
+int saveMapCache(const Map *map, const char *filename);
+
+
+// Maps the given cache file read-only, and returns a map using its memory, to be freed with freeMap(). Candidate
+// lists can still be built again with initCandidates(), but initMap() must not be called. Returns NULL on failure.
+Map* openMapCache(const char *filename);
+
+
+// Opens the cache of the given TSPLIB dataset if it is up to date, and has been built with the same rounding,
+// numbering and number of candidates (0 for none). Else the dataset is loaded, and its cache written for the next times.
+// Exits if the dataset can't be loaded, as getMapFromDataset() does.
+Map* getCachedMap(const char *dataset, const char *cache, DistanceRounding distMode, int candidates_number);
+
+
+#endif
@@ -1,10 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "matrix.h"
 #include "rng32.h"
 
 
+#define CACHE_LINE 64
+
+
 // Every field is initialized to 0.
 num_map** createFloatMatrix(int rows, int cols)
 {
@@ -43,6 +47,57 @@ void freeFloatMatrix(num_map **matrix, int rows)
 }
 
 
+// Zeroed block of the given number of distances, aligned on cache lines:
+static num_dist* createDistanceBlock(size_t values_number)
+{
+	// One more cache line, for vectorized gathers which may read slightly past the last value,
+	// and another one to keep the original address just before the aligned block:
+	size_t size = values_number * sizeof(num_dist) + 3 * CACHE_LINE;
+
+	char *block = (char*) calloc(size, 1);
+
+	if (block == NULL)
+	{
+		printf("\nImpossible to allocate enough memory for a distance matrix.\n\n");
+		return NULL;
+	}
+
+	char *aligned = block + 2 * CACHE_LINE - (uintptr_t) block % CACHE_LINE;
+	((char**) aligned)[-1] = block;
+
+	return (num_dist*) aligned;
+}
+
+
+// Every field is initialized to 0. The matrix is stored in a single block aligned on cache lines, its rows being
+// padded to a multiple of the cache line size. The padded row length is saved in 'stride'.
+num_dist* createDistanceMatrix(int rows, int cols, int *stride)
+{
+	const size_t values_per_line = CACHE_LINE / sizeof(num_dist);
+
+	*stride = (cols + values_per_line - 1) / values_per_line * values_per_line;
+
+	return createDistanceBlock((size_t) rows * *stride);
+}
+
+
+// Every field is initialized to 0. Packed lower triangle of a symmetric matrix of the given size, diagonal included,
+// in a single block aligned on cache lines. Freed with freeDistanceMatrix() as well.
+num_dist* createTriangularMatrix(int size)
+{
+	return createDistanceBlock((size_t) size * (size + 1) / 2);
+}
+
+
+void freeDistanceMatrix(num_dist *matrix)
+{
+	if (matrix == NULL)
+		return;
+
+	free(((char**) matrix)[-1]);
+}
+
+
 void printFloatMatrix(num_map **matrix, int rows, int cols)
 {
 	if (matrix == NULL)
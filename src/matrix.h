@@ -15,6 +15,19 @@ void freeFloatMatrix(num_map **matrix, int rows);
 void printFloatMatrix(num_map **matrix, int rows, int cols);
 
 
+// Every field is initialized to 0. The matrix is stored in a single block aligned on cache lines, its rows being
+// padded to a multiple of the cache line size. The padded row length is saved in 'stride'.
+num_dist* createDistanceMatrix(int rows, int cols, int *stride);
+
+
+// Every field is initialized to 0. Packed lower triangle of a symmetric matrix of the given size, diagonal included,
+// in a single block aligned on cache lines. Freed with freeDistanceMatrix() as well.
+num_dist* createTriangularMatrix(int size);
+
+
+void freeDistanceMatrix(num_dist *matrix);
+
+
 // Filling randomly a num_map matrix with uniform distribution:
 void randomFloatMatrix_uniform(void *rng, num_map **matrix, int rows, int cols, num_map min, num_map max);
 
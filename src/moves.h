@@ -0,0 +1,104 @@
+#ifndef MOVES_H
+#define MOVES_H
+
+
+#include "salesman.h"
+#include "sales_gen.h" // for mirrorWithPositions()
+
+
+// Neighborhoods of the local searches, to be combined with a bitwise OR:
+typedef enum {MOVE_2OPT = 1, MOVE_OR_OPT = 2, MOVE_3OPT = 4} MoveType;
+
+
+#define OR_OPT_MAX_LENGTH 3
+#define SEGMENT_INSERTION_MAX_LENGTH 50 // for 3-opt moves. Longer segments are slower to move, and rarely useful.
+
+
+// Move of a path, whose first city stays at index 0. If 'insertion' is negative, this is a 2-opt move mirroring
+// the subpath [start, end]. Else, this subpath is moved between the indexes 'insertion' and 'insertion' + 1
+// (modulo the cities number), and mirrored if 'reversed': an Or-opt move for short segments, a 3-opt one otherwise.
+// Needed: 0 < start <= end, and 'insertion' not in [start - 1, end].
+typedef struct
+{
+	int start;
+	int end;
+	int insertion;
+	int reversed;
+} Move;
+
+
+// Old length - new length, in O(1):
+static inline double moveDelta(const Map *map, const int *path, const Move *move)
+{
+	const int last_index = map -> CitiesNumber - 1;
+
+	int city_ps = path[move -> start - 1], city_s = path[move -> start];
+	int city_e = path[move -> end], city_se = path[move -> end == last_index ? 0 : move -> end + 1];
+
+	if (move -> insertion < 0)
+		return getDistance(map, city_ps, city_s) + getDistance(map, city_e, city_se)
+			 - getDistance(map, city_ps, city_e) - getDistance(map, city_s, city_se);
+
+	int city_i = path[move -> insertion], city_si = path[move -> insertion == last_index ? 0 : move -> insertion + 1];
+
+	double old_length = getDistance(map, city_ps, city_s) + getDistance(map, city_e, city_se)
+		+ getDistance(map, city_i, city_si);
+
+	double new_length = getDistance(map, city_ps, city_se) + (move -> reversed ?
+		getDistance(map, city_i, city_e) + getDistance(map, city_s, city_si) :
+		getDistance(map, city_i, city_s) + getDistance(map, city_e, city_si));
+
+	return old_length - new_length;
+}
+
+
+static inline void mirrorMove(int *path, int *positions, int start, int end)
+{
+	if (positions)
+		mirrorWithPositions(path, positions, start, end);
+	else
+		mirror(path, start, end);
+}
+
+
+// Applies the move, keeping 'positions' the inverse of 'path' if not NULL. Segments are moved with at most
+// three mirrorings.
+static inline void applyMove(int *path, int *positions, const Move *move)
+{
+	const int start = move -> start, end = move -> end, insertion = move -> insertion;
+	const int length = end - start + 1;
+
+	if (insertion < 0)
+		mirrorMove(path, positions, start, end);
+
+	else if (insertion > end) // [segment, next] -> [next, segment]
+	{
+		mirrorMove(path, positions, start, insertion);
+		mirrorMove(path, positions, start, insertion - length);
+
+		if (!move -> reversed)
+			mirrorMove(path, positions, insertion - length + 1, insertion);
+	}
+
+	else // [previous, segment] -> [segment, previous]
+	{
+		mirrorMove(path, positions, insertion + 1, end);
+		mirrorMove(path, positions, insertion + 1 + length, end);
+
+		if (!move -> reversed)
+			mirrorMove(path, positions, insertion + 1, insertion + length);
+	}
+}
+
+
+// Longest moved segment for the given neighborhoods, 0 if they only contain 2-opt moves:
+static inline int segmentMaxLength(int neighborhoods)
+{
+	if (neighborhoods & MOVE_3OPT)
+		return SEGMENT_INSERTION_MAX_LENGTH;
+
+	return neighborhoods & MOVE_OR_OPT ? OR_OPT_MAX_LENGTH : 0;
+}
+
+
+#endif
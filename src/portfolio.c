@@ -0,0 +1,166 @@
+#define _POSIX_C_SOURCE 200809L // for pthreads.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "portfolio.h"
+#include "incumbent.h"
+#include "local_search.h"
+#include "sales_gen.h"
+#include "get_time.h"
+
+
+typedef struct
+{
+	const char *name;
+	const GeneticMethods *genMeth; // NULL for a local search.
+	localSearchMode mode;
+	double populationRatio; // relatively to 'settings -> populationSize'.
+} PortfolioSolver;
+
+
+static const PortfolioSolver Solvers[] =
+{
+	{"STOCHASTIC", NULL, STOCHASTIC, 2.},
+	{"GREEDY", NULL, GREEDY, 2.},
+	{"SA", NULL, SA, 1.},
+	{"TA", NULL, TA, 1.},
+	{"GA 1", &GeneMeth_salesman_1, 0, 1.},
+	{"GA 2", &GeneMeth_salesman_2, 0, 0.25}
+};
+
+
+#define SOLVERS_NUMBER ((int) (sizeof(Solvers) / sizeof(PortfolioSolver)))
+
+
+typedef struct
+{
+	const PortfolioSettings *settings;
+	const Map *map;
+	Incumbent *incumbent;
+	int index;
+	double timeStart;
+} SolverThread;
+
+
+static void runGeneticSolver(const SolverThread *solver, int population_size)
+{
+	const PortfolioSettings *settings = solver -> settings;
+
+	Species *species = createSpecies(Solvers[solver -> index].genMeth, solver -> map, population_size);
+
+	if (!species)
+		return;
+
+	if (settings -> targetLength > 0.)
+		species -> targetFitness = salesmanFitness(settings -> targetLength);
+
+	while (get_time() - solver -> timeStart < settings -> timeBudget
+		&& getIncumbentLength(solver -> incumbent) > settings -> targetLength)
+	{
+		geneticStep(species, PORTFOLIO_GENETIC_STEP);
+
+		const int *best_path = (const int*) getBestGene(species, NULL);
+
+		offerPath(solver -> incumbent, solver -> index, best_path, pathLength(solver -> map, best_path));
+	}
+
+	destroySpecies(&species);
+}
+
+
+static void* solverLoop(void *arg)
+{
+	const SolverThread *solver = (SolverThread*) arg;
+	const PortfolioSettings *settings = solver -> settings;
+
+	int population_size = settings -> populationSize * Solvers[solver -> index].populationRatio;
+
+	if (population_size < 1)
+		population_size = 1;
+
+	if (Solvers[solver -> index].genMeth)
+	{
+		runGeneticSolver(solver, population_size);
+		return NULL;
+	}
+
+	LocalSearchSettings ls_settings =
+	{
+		.temperature = settings -> temperature,
+		.verbose = 0,
+		.timeBudget = settings -> timeBudget - (get_time() - solver -> timeStart),
+		.targetLength = settings -> targetLength,
+		.incumbent = solver -> incumbent,
+		.incumbentWriter = solver -> index
+	};
+
+	if (ls_settings.timeBudget > 0.)
+		localSearch(&ls_settings, solver -> map, population_size, LONG_MAX, Solvers[solver -> index].mode);
+
+	return NULL;
+}
+
+
+// Runs concurrently, one thread each, the STOCHASTIC, GREEDY, SA and TA local searches, and genetic searches
+// with GeneMeth_salesman_1 and GeneMeth_salesman_2. They share an incumbent, so that the search stops as soon as
+// one of them reaches the target. Returns the best found length, and fills 'best_path' if not NULL.
+double portfolioSearch(const PortfolioSettings *settings, const Map *map, int *best_path)
+{
+	double time_start = get_time();
+
+	if (!settings || !map || settings -> timeBudget <= 0. || settings -> populationSize < 1)
+	{
+		printf("\nInvalid argument in 'portfolioSearch()'.\n\n");
+		return INFINITY;
+	}
+
+	Incumbent *incumbent = createIncumbent(map -> CitiesNumber, SOLVERS_NUMBER);
+
+	if (!incumbent)
+		return INFINITY;
+
+	SolverThread solvers[SOLVERS_NUMBER];
+	pthread_t threads[SOLVERS_NUMBER];
+	int started[SOLVERS_NUMBER];
+
+	for (int i = 0; i < SOLVERS_NUMBER; ++i)
+	{
+		solvers[i] = (SolverThread) {settings, map, incumbent, i, time_start};
+		started[i] = pthread_create(threads + i, NULL, solverLoop, solvers + i) == 0;
+
+		if (!started[i])
+			printf("\nCould not start the solver '%s'.\n", Solvers[i].name);
+	}
+
+	for (int i = 0; i < SOLVERS_NUMBER; ++i)
+	{
+		if (started[i])
+			pthread_join(threads[i], NULL);
+	}
+
+	int *path = (int*) calloc(map -> CitiesNumber, sizeof(int));
+	int writer_index = -1;
+
+	double best_length = getIncumbent(incumbent, path, &writer_index);
+
+	if (best_path && writer_index >= 0)
+		memcpy(best_path, path, map -> CitiesNumber * sizeof(int));
+
+	if (settings -> verbose && writer_index >= 0)
+	{
+		printf("\nPortfolio search:\n -> Time elapsed: %.3f s, best found length: %.3f, found by: %s\n\nBest path:\n",
+			get_time() - time_start, best_length, Solvers[writer_index].name);
+
+		printPath(map, path);
+	}
+
+	free(path);
+	freeIncumbent(&incumbent);
+
+	return best_length;
+}
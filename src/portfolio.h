@@ -0,0 +1,27 @@
+#ifndef PORTFOLIO_H
+#define PORTFOLIO_H
+
+
+#include "salesman.h"
+
+
+#define PORTFOLIO_GENETIC_STEP 10000L // epochs between two checks of a genetic search.
+
+
+typedef struct
+{
+	double timeBudget; // In seconds, shared by all solvers.
+	double targetLength; // All solvers stop as soon as a path this short is found, 0 for none.
+	float temperature; // Initial temperature, for SA and TA.
+	int populationSize;
+	int verbose; // Printing the search results and the best found path.
+} PortfolioSettings;
+
+
+// Runs concurrently, one thread each, the STOCHASTIC, GREEDY, SA and TA local searches, and genetic searches
+// with GeneMeth_salesman_1 and GeneMeth_salesman_2. They share an incumbent, so that the search stops as soon as
+// one of them reaches the target. Returns the best found length, and fills 'best_path' if not NULL.
+double portfolioSearch(const PortfolioSettings *settings, const Map *map, int *best_path);
+
+
+#endif
@@ -3,25 +3,115 @@
 #include <string.h>
 
 #include "sales_gen.h"
+#include "moves.h"
 #include "rng32.h"
 
 
+size_t salesmanGeneSize(const Map *map)
+{
+	return (geneLengthIndex(map) + 1) * sizeof(double);
+}
+
+
+// Creates a species whose first genes are copies of the given paths (e.g read with readTour()), the others being
+// created by the genetic methods. Warm starts the search from known solutions. Returns NULL on failure.
+Species* createSalesmanSpecies(const GeneticMethods *genMeth, const Map *map, int population_size, int **seed_paths,
+	int seed_paths_number)
+{
+	if (!map || (!seed_paths && seed_paths_number > 0))
+	{
+		printf("\nInvalid argument in 'createSalesmanSpecies()'.\n\n");
+		return NULL;
+	}
+
+	Species *species = createSpecies(genMeth, map, population_size);
+
+	if (!species || seed_paths_number <= 0)
+		return species;
+
+	if (seed_paths_number > population_size)
+		seed_paths_number = population_size;
+
+	const size_t gene_size = salesmanGeneSize(map);
+
+	void **genes = (void**) malloc(seed_paths_number * sizeof(void*));
+	char *genes_block = (char*) calloc(seed_paths_number, gene_size);
+
+	if (!genes || !genes_block)
+	{
+		printf("\nNot enough memory to create a new species.\n");
+		free(genes);
+		free(genes_block);
+		destroySpecies(&species);
+		return NULL;
+	}
+
+	for (int i = 0; i < seed_paths_number; ++i)
+	{
+		genes[i] = genes_block + i * gene_size;
+
+		seedPath((int*) genes[i], seed_paths[i], map -> CitiesNumber);
+		setGeneLength(map, genes[i], pathLength(map, (int*) genes[i]));
+	}
+
+	seedSpecies(species, genes, seed_paths_number);
+
+	free(genes);
+	free(genes_block);
+
+	return species;
+}
+
+
 static void* createGene(const void *context, void *rng)
 {
 	const Map *map = (Map*) context;
-	int *gene_tofill = (int*) calloc(map -> CitiesNumber, sizeof(int));
+	int *gene_tofill = (int*) calloc(salesmanGeneSize(map), 1);
 
-	initPath(rng, gene_tofill, map -> CitiesNumber, DEFAULT_INIT_MODE);
+	initPath(map, rng, gene_tofill, DEFAULT_INIT_MODE);
+	setGeneLength(map, gene_tofill, pathLength(map, gene_tofill));
 
 	return gene_tofill;
 }
 
 
+static void initGene(const void *context, void *rng, void *gene)
+{
+	const Map *map = (Map*) context;
+
+	initPath(map, rng, (int*) gene, DEFAULT_INIT_MODE);
+	setGeneLength(map, gene, pathLength(map, (int*) gene));
+}
+
+
+// Fully random genes, for crossovers needing a diverse population:
+
+static void* createRandomGene(const void *context, void *rng)
+{
+	const Map *map = (Map*) context;
+	int *gene_tofill = (int*) calloc(salesmanGeneSize(map), 1);
+
+	initPath(map, rng, gene_tofill, FULL_RANDOM_INIT);
+	setGeneLength(map, gene_tofill, pathLength(map, gene_tofill));
+
+	return gene_tofill;
+}
+
+
+static void initRandomGene(const void *context, void *rng, void *gene)
+{
+	const Map *map = (Map*) context;
+
+	initPath(map, rng, (int*) gene, FULL_RANDOM_INIT);
+	setGeneLength(map, gene, pathLength(map, (int*) gene));
+}
+
+
 static void copyGene(const void *context, void *gene_tofill, const void *gene)
 {
 	const Map *map = (Map*) context;
 
-	memcpy(gene_tofill, gene, map -> CitiesNumber * sizeof(int)); // copying even the first city!
+	memcpy(gene_tofill, gene, salesmanGeneSize(map)); // copying even the first city, and the length!
 }
 
 
@@ -35,7 +125,7 @@ static double fitness(const void *context, const void *gene, long epoch)
 {
 	const Map *map = (Map*) context;
 
-	return FITNESS_SCALE / pathLength(map, (int*) gene);
+	return salesmanFitness(getGeneLength(map, gene));
 }
 
 
@@ -59,6 +149,26 @@ inline static int findIndexOfValue(const int *array, int length, int start, int
 }
 
 
+// Inverse of the given path, indexed by city, so that crossovers find the index of a city in O(1).
+// Allocated at each call, so that species sharing a map can be used by several threads at once.
+// Returns NULL on memory error.
+static int* createPositions(const int *path, int length)
+{
+	int *positions = (int*) malloc(length * sizeof(int));
+
+	if (!positions)
+	{
+		printf("\nNot enough memory for a crossover.\n");
+		return NULL;
+	}
+
+	for (int i = 0; i < length; ++i)
+		positions[path[i]] = i;
+
+	return positions;
+}
+
+
 void crossover_1(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
 	double fitness_1, double fitness_2, long epoch)
 {
@@ -68,17 +178,29 @@ void crossover_1(const void *context, void *rng, void *gene_tofill, const void *
 
 	const int start = 1; // First city fixed!
 
+	int *positions_2 = createPositions(path_2, length);
+
+	if (!positions_2)
+	{
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
 	for (int i = start; i < length; ++i) // Necessary setup.
 		new_path[i] = -1;
 
+	int blanck_spot_index = start; // first blank spot, which can only move forward.
+
 	for (int i = start; i < length; ++i)
 	{
 		int pivot_index = i, pivot = path_1[i];
-		int found_index = findIndexOfValue(path_2, length, start, pivot);
+		int found_index = positions_2[pivot];
 
 		if (new_path[pivot_index] >= 0 && new_path[found_index] >= 0)
 		{
-			int blanck_spot_index = findIndexOfValue(new_path, length, start, -1);
+			while (new_path[blanck_spot_index] >= 0)
+				++blanck_spot_index;
+
 			new_path[blanck_spot_index] = pivot;
 		}
 
@@ -95,14 +217,15 @@ void crossover_1(const void *context, void *rng, void *gene_tofill, const void *
 		}
 	}
 
+	free(positions_2);
+
 	// Preventing useless symmetric representation:
 	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
 		swap(new_path, 1, length - 1);
-}
 
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
+}
 
-static int *CountBuffer = NULL; // No parallelization possible with this !!!
-// This should be added to the context, eventually.
 
 void crossover_2(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
 	double fitness_1, double fitness_2, long epoch)
@@ -114,24 +237,26 @@ void crossover_2(const void *context, void *rng, void *gene_tofill, const void *
 	int start = 1; // First city fixed!
 	const int pivot = rng32_nextInt(rng) % length;
 
-	if (!CountBuffer)
-		CountBuffer = (int*) calloc(length, sizeof(int));
-	else
+	// Occurrences of each city in the new path. Allocated at each call, to be thread safe:
+	int *count = (int*) calloc(length, sizeof(int));
+
+	if (!count)
 	{
-		for (int i = start; i < length; ++i)
-			CountBuffer[i] = 0;
+		printf("\nNot enough memory for a crossover.\n");
+		copyGene(context, gene_tofill, gene_1);
+		return;
 	}
 
 	for (int i = start; i <= pivot; ++i)
 	{
 		new_path[i] = path_1[i];
-		++CountBuffer[path_1[i]];
+		++count[path_1[i]];
 	}
 
 	for (int i = pivot + 1; i < length; ++i)
 	{
 		new_path[i] = path_2[i];
-		++CountBuffer[path_2[i]];
+		++count[path_2[i]];
 	}
 
 	// Do _not_ move the counting part to the next loop!
@@ -146,18 +271,23 @@ void crossover_2(const void *context, void *rng, void *gene_tofill, const void *
 
 	for (int i = begin; i <= end; ++i) // Less biased hopefully...
 	{
-		if (CountBuffer[new_path[i]] == 2)
+		if (count[new_path[i]] == 2)
 		{
-			int absent_value = findIndexOfValue(CountBuffer, length, start, 0);
+			// Absent values are found in increasing order, hence a single pass over 'count':
+			int absent_value = findIndexOfValue(count, length, start, 0);
 
 			new_path[i] = absent_value;
 			start = absent_value + 1;
 		}
 	}
 
+	free(count);
+
 	// Preventing useless symmetric representation:
 	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
 		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
 }
 
 
@@ -172,6 +302,14 @@ void crossover_3(const void *context, void *rng, void *gene_tofill, const void *
 	const int start = 1; // First city fixed!
 	const int pivot = rng32_nextInt(rng) % length;
 
+	int *positions_2 = createPositions(path_2, length);
+
+	if (!positions_2)
+	{
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
 	for (int i = start; i < length; ++i)
 	{
 		new_path[i] = path_2[i];
@@ -179,14 +317,555 @@ void crossover_3(const void *context, void *rng, void *gene_tofill, const void *
 
 	for (int i = start; i <= pivot; ++i)
 	{
-		int index = findIndexOfValue(path_2, length, start, path_1[i]);
+		int index = positions_2[path_1[i]];
 
 		swap(new_path, i, index);
 	}
 
+	free(positions_2);
+
+	// Preventing useless symmetric representation:
+	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
+		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
+}
+
+
+// Order crossover (OX): a random segment of the first parent is kept, and the other cities are placed after it,
+// in the order they have in the second parent when starting after the same segment.
+void crossover_4(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
+	double fitness_1, double fitness_2, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *path_1 = (int*) gene_1, *path_2 = (int*) gene_2, *new_path = (int*) gene_tofill;
+
+	int *positions_1 = createPositions(path_1, length);
+
+	if (!positions_1)
+	{
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
+	int seg_start, seg_end;
+
+	getStrictCouple(rng, &seg_start, &seg_end, length - 1); // First city fixed!
+
+	++seg_start;
+	++seg_end;
+
+	for (int i = seg_start; i <= seg_end; ++i)
+		new_path[i] = path_1[i];
+
+	int index = seg_end;
+
+	// Indexes after the segment, wrapping over [1, length - 1]:
+	for (int k = 1; k < length; ++k)
+	{
+		int j = seg_end + k >= length ? seg_end + k - (length - 1) : seg_end + k;
+		int city = path_2[j];
+
+		if (positions_1[city] >= seg_start && positions_1[city] <= seg_end)
+			continue;
+
+		index = index + 1 == length ? 1 : index + 1;
+		new_path[index] = city;
+	}
+
+	free(positions_1);
+
+	// Preventing useless symmetric representation:
+	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
+		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
+}
+
+
+// Partially mapped crossover (PMX): a random segment of the first parent is kept, the other indexes take the cities
+// of the second parent. Those already in the segment are replaced by following the mapping between the two segments.
+void crossover_5(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
+	double fitness_1, double fitness_2, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *path_1 = (int*) gene_1, *path_2 = (int*) gene_2, *new_path = (int*) gene_tofill;
+
+	int *positions_1 = createPositions(path_1, length);
+
+	if (!positions_1)
+	{
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
+	int seg_start, seg_end;
+
+	getStrictCouple(rng, &seg_start, &seg_end, length - 1); // First city fixed!
+
+	++seg_start;
+	++seg_end;
+
+	for (int i = 1; i < length; ++i)
+	{
+		if (i >= seg_start && i <= seg_end)
+		{
+			new_path[i] = path_1[i];
+			continue;
+		}
+
+		// Each mapping chain being followed only once, this is linear overall:
+		int city = path_2[i];
+
+		while (positions_1[city] >= seg_start && positions_1[city] <= seg_end)
+			city = path_2[positions_1[city]];
+
+		new_path[i] = city;
+	}
+
+	free(positions_1);
+
+	// Preventing useless symmetric representation:
+	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
+		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
+}
+
+
+// Cycle crossover (CX): the indexes are split into cycles, on which both parents hold the same cities.
+// Cycles are taken alternately from each parent, so that every city keeps the index it has in one of them.
+void crossover_6(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
+	double fitness_1, double fitness_2, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *path_1 = (int*) gene_1, *path_2 = (int*) gene_2, *new_path = (int*) gene_tofill;
+
+	const int start = 1; // First city fixed!
+
+	int *positions_1 = createPositions(path_1, length);
+
+	if (!positions_1)
+	{
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
+	for (int i = start; i < length; ++i)
+		new_path[i] = -1;
+
+	int from_first = rng32_nextInt(rng) % 2;
+
+	for (int i = start; i < length; ++i)
+	{
+		if (new_path[i] >= 0)
+			continue;
+
+		int j = i;
+
+		do
+		{
+			new_path[j] = from_first ? path_1[j] : path_2[j];
+			j = positions_1[path_2[j]];
+		}
+		while (j != i);
+
+		from_first = !from_first;
+	}
+
+	free(positions_1);
+
+	// Preventing useless symmetric representation:
+	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
+		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, pathLength(map, new_path));
+}
+
+
+// Edge assembly crossover (EAX) helpers. Edges are stored as neighbor slots, 2 per city in 'links', -1 if free.
+
+static inline void unlinkCities(int *links, int u, int v)
+{
+	links[2 * u + (links[2 * u] == v ? 0 : 1)] = -1;
+	links[2 * v + (links[2 * v] == u ? 0 : 1)] = -1;
+}
+
+
+static inline void linkCities(int *links, int u, int v)
+{
+	links[2 * u + (links[2 * u] < 0 ? 0 : 1)] = v;
+	links[2 * v + (links[2 * v] < 0 ? 0 : 1)] = u;
+}
+
+
+static inline int otherLink(const int *links, int city, int previous)
+{
+	return links[2 * city] == previous ? links[2 * city + 1] : links[2 * city];
+}
+
+
+// Removes the edge (u, v) of the given parent (0 or 1) from the edges left to build AB-cycles:
+static inline void removeRemainingEdge(int *remaining, int *remaining_number, int parent, int u, int v)
+{
+	for (int side = 0; side < 2; ++side)
+	{
+		int *list = remaining + 4 * u + 2 * parent, *number = remaining_number + 2 * u + parent;
+
+		int k = list[0] == v ? 0 : 1;
+		list[k] = list[--(*number)];
+
+		int temp = u;
+		u = v;
+		v = temp;
+	}
+}
+
+
+// Best 2-exchange merging the subtour of the cities 'subtour' with another one: an edge (u, u2) of the subtour
+// and an edge (v, v2) of another one are replaced by (u, v) and (u2, v2), or by (u, v2) and (u2, v), 'v' being
+// a candidate of 'u' if 'use_candidates', else any city. Returns 0 if no other subtour has been met.
+static int bestMerge(const Map *map, const int *links, const int *labels, const int *subtour, int size,
+	int use_candidates, int best[4])
+{
+	const int label = labels[subtour[0]];
+	const int neighbors_number = use_candidates ? map -> CandidatesNumber : map -> CitiesNumber;
+
+	double best_gain = -DBL_MAX;
+
+	for (int i = 0; i < size; ++i)
+	{
+		const int u = subtour[i];
+		const int *candidates = use_candidates ? getCandidates(map, u) : NULL;
+
+		for (int k = 0; k < neighbors_number; ++k)
+		{
+			const int v = use_candidates ? candidates[k] : k;
+
+			if (labels[v] == label)
+				continue;
+
+			for (int s = 0; s < 2; ++s)
+			{
+				const int u2 = links[2 * u + s];
+				const double removed = getDistance(map, u, u2);
+
+				for (int t = 0; t < 2; ++t)
+				{
+					const int v2 = links[2 * v + t];
+					const double base = removed + getDistance(map, v, v2);
+
+					double gain = base - getDistance(map, u, v) - getDistance(map, u2, v2);
+
+					if (gain > best_gain)
+					{
+						best_gain = gain;
+						best[0] = u; best[1] = u2; best[2] = v; best[3] = v2;
+					}
+
+					gain = base - getDistance(map, u, v2) - getDistance(map, u2, v);
+
+					if (gain > best_gain)
+					{
+						best_gain = gain;
+						best[0] = u; best[1] = u2; best[2] = v2; best[3] = v;
+					}
+				}
+			}
+		}
+	}
+
+	return best_gain > -DBL_MAX;
+}
+
+
+// Builds in 'links' the child of the parent 'path' to which the given AB-cycle is applied: its A-edges are replaced
+// by its B-edges, the former being removed first so that cities never have more than 2 links. This may split
+// the tour into subtours, which are merged greedily, smallest first, by the best 2-exchange found among the
+// candidates, or among all cities if there are none. Returns the length variation from the parent.
+static double buildEaxChild(const Map *map, const int *path, const int *cycle, int cycle_length, int first_parent,
+	int *links, int *labels, int *subtour_sizes, int *subtour_first, int *subtour)
+{
+	const int length = map -> CitiesNumber;
+
+	double delta = 0.;
+
+	for (int i = 0; i < length; ++i)
+	{
+		links[2 * path[i]] = path[i == 0 ? length - 1 : i - 1];
+		links[2 * path[i] + 1] = path[i == length - 1 ? 0 : i + 1];
+	}
+
+	for (int parent = 0; parent < 2; ++parent)
+	{
+		for (int i = 0; i < cycle_length; ++i)
+		{
+			if ((first_parent + i) % 2 != parent)
+				continue;
+
+			const int u = cycle[i], v = cycle[i + 1 == cycle_length ? 0 : i + 1];
+
+			if (parent == 0)
+			{
+				unlinkCities(links, u, v);
+				delta -= getDistance(map, u, v);
+			}
+			else
+			{
+				linkCities(links, u, v);
+				delta += getDistance(map, u, v);
+			}
+		}
+	}
+
+	// Labeling the subtours:
+
+	int subtours_number = 0;
+
+	for (int i = 0; i < length; ++i)
+		labels[i] = -1;
+
+	for (int city = 0; city < length; ++city)
+	{
+		if (labels[city] >= 0)
+			continue;
+
+		int previous = links[2 * city + 1], current = city, size = 0;
+
+		do
+		{
+			labels[current] = subtours_number;
+			++size;
+
+			int next = otherLink(links, current, previous);
+			previous = current;
+			current = next;
+		}
+		while (current != city);
+
+		subtour_sizes[subtours_number] = size;
+		subtour_first[subtours_number] = city;
+		++subtours_number;
+	}
+
+	// Merging the subtours, smallest first:
+
+	for (int alive_number = subtours_number; alive_number > 1; --alive_number)
+	{
+		int smallest = -1;
+
+		for (int i = 0; i < subtours_number; ++i)
+		{
+			if (subtour_sizes[i] > 0 && (smallest < 0 || subtour_sizes[i] < subtour_sizes[smallest]))
+				smallest = i;
+		}
+
+		const int size = subtour_sizes[smallest];
+		int previous = links[2 * subtour_first[smallest] + 1], current = subtour_first[smallest];
+
+		for (int i = 0; i < size; ++i)
+		{
+			subtour[i] = current;
+
+			int next = otherLink(links, current, previous);
+			previous = current;
+			current = next;
+		}
+
+		int best[4];
+
+		if (!(map -> CandidatesNumber > 0 && bestMerge(map, links, labels, subtour, size, 1, best)))
+			bestMerge(map, links, labels, subtour, size, 0, best);
+
+		const int target = labels[best[2]];
+
+		delta += getDistance(map, best[0], best[2]) + getDistance(map, best[1], best[3])
+			- getDistance(map, best[0], best[1]) - getDistance(map, best[2], best[3]);
+
+		unlinkCities(links, best[0], best[1]);
+		unlinkCities(links, best[2], best[3]);
+		linkCities(links, best[0], best[2]);
+		linkCities(links, best[1], best[3]);
+
+		for (int i = 0; i < size; ++i)
+			labels[subtour[i]] = target;
+
+		subtour_sizes[target] += size;
+		subtour_sizes[smallest] = 0;
+	}
+
+	return delta;
+}
+
+
+// Edge assembly crossover (EAX), with single AB-cycles as E-sets (EAX-1AB). The edges of the parents which aren't
+// shared are split into AB-cycles, alternating edges of the first (A) and second (B) parent. A child is built from
+// the first parent for up to EAX_TRIES random AB-cycles (see buildEaxChild()), and the shortest one is kept.
+void crossover_7(const void *context, void *rng, void *gene_tofill, const void *gene_1, const void *gene_2,
+	double fitness_1, double fitness_2, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *path_1 = (int*) gene_1, *path_2 = (int*) gene_2, *new_path = (int*) gene_tofill;
+
+	// Scratch memory, allocated at each call as for the other crossovers:
+	int *memory = (int*) malloc((size_t) 20 * length * sizeof(int));
+
+	if (!memory)
+	{
+		printf("\nNot enough memory for a crossover.\n");
+		copyGene(context, gene_tofill, gene_1);
+		return;
+	}
+
+	int *links = memory; // 2 per city: neighbors in the child being built.
+	int *remaining = links + 2 * length; // 4 per city: A-edges, then B-edges, not yet in an AB-cycle.
+	int *remaining_number = remaining + 4 * length; // 2 per city.
+	int *stack = remaining_number + 2 * length; // alternating path being built, up to 2 visits per city.
+	int *stack_index = stack + 2 * length; // 2 per city: index in the stack for each parity, -1 if absent.
+	int *cycles = stack_index + 2 * length; // each AB-cycle: the parent of its first edge, then its cities.
+	int *cycles_start = cycles + 3 * length; // at most length / 2 AB-cycles, of 4 edges or more.
+	int *labels = cycles_start + length; // subtour of each city.
+	int *subtour_sizes = labels + length;
+	int *subtour_first = subtour_sizes + length;
+
+	int *positions_2 = stack; // only used before building the AB-cycles.
+
+	for (int i = 0; i < length; ++i)
+		positions_2[path_2[i]] = i;
+
+	for (int i = 0; i < length; ++i)
+	{
+		const int city = path_1[i];
+		const int j = positions_2[city];
+
+		const int a_links[2] = {path_1[i == 0 ? length - 1 : i - 1], path_1[i == length - 1 ? 0 : i + 1]};
+		const int b_links[2] = {path_2[j == 0 ? length - 1 : j - 1], path_2[j == length - 1 ? 0 : j + 1]};
+
+		remaining_number[2 * city] = 0;
+		remaining_number[2 * city + 1] = 0;
+
+		for (int s = 0; s < 2; ++s)
+		{
+			if (a_links[s] != b_links[0] && a_links[s] != b_links[1])
+				remaining[4 * city + remaining_number[2 * city]++] = a_links[s];
+
+			if (b_links[s] != a_links[0] && b_links[s] != a_links[1])
+				remaining[4 * city + 2 + remaining_number[2 * city + 1]++] = b_links[s];
+		}
+	}
+
+	for (int i = 0; i < 2 * length; ++i)
+		stack_index[i] = -1;
+
+	// Building the AB-cycles, by random alternating walks. The edge leaving the stack index 'top' is an A-edge if
+	// 'top' is even. When the walk comes back to a city with the right parity, the loop is saved as an AB-cycle:
+
+	int cycles_number = 0;
+	cycles_start[0] = 0;
+
+	for (int start = 0; start < length; ++start)
+	{
+		while (remaining_number[2 * start] > 0)
+		{
+			int top = 0;
+
+			stack[0] = start;
+			stack_index[2 * start] = 0;
+
+			while (1)
+			{
+				const int city = stack[top], parent = top % 2;
+				const int number = remaining_number[2 * city + parent];
+
+				if (number == 0) // only happens at the start city, once all its AB-cycles are found.
+				{
+					for (int i = 0; i <= top; ++i)
+						stack_index[2 * stack[i] + i % 2] = -1;
+					break;
+				}
+
+				const int next = remaining[4 * city + 2 * parent + rng32_nextInt(rng) % number];
+
+				removeRemainingEdge(remaining, remaining_number, parent, city, next);
+
+				const int parity = (top + 1) % 2;
+				const int closing = stack_index[2 * next + parity];
+
+				if (closing < 0)
+				{
+					stack[++top] = next;
+					stack_index[2 * next + parity] = top;
+					continue;
+				}
+
+				// The AB-cycle is stack[closing, top], its first edge being an A-edge if 'closing' is even:
+
+				int end = cycles_start[cycles_number];
+
+				cycles[end++] = closing % 2;
+
+				for (int i = closing; i <= top; ++i)
+					cycles[end++] = stack[i];
+
+				cycles_start[++cycles_number] = end;
+
+				for (int i = closing + 1; i <= top; ++i)
+					stack_index[2 * stack[i] + i % 2] = -1;
+
+				top = closing;
+			}
+		}
+	}
+
+	copyGene(context, gene_tofill, gene_1); // also the result for identical parents.
+
+	// Trying random AB-cycles, all of them if there are few:
+
+	const int tries_number = cycles_number < EAX_TRIES ? cycles_number : EAX_TRIES;
+	const int first_try = cycles_number <= EAX_TRIES ? 0 : rng32_nextInt(rng) % cycles_number;
+
+	double best_delta = 0.;
+
+	for (int t = 0; t < tries_number; ++t)
+	{
+		const int chosen = cycles_number <= EAX_TRIES ? t : (first_try + t * (cycles_number / EAX_TRIES)) % cycles_number;
+		const int *cycle = cycles + cycles_start[chosen] + 1;
+		const int cycle_length = cycles_start[chosen + 1] - cycles_start[chosen] - 1;
+
+		double delta = buildEaxChild(map, path_1, cycle, cycle_length, cycles[cycles_start[chosen]], links, labels,
+			subtour_sizes, subtour_first, stack);
+
+		if (delta >= best_delta && t > 0)
+			continue;
+
+		// Writing the child, from the first city:
+
+		best_delta = delta;
+
+		int previous = 0, current = links[0];
+
+		for (int i = 1; i < length; ++i)
+		{
+			new_path[i] = current;
+
+			int next = otherLink(links, current, previous);
+			previous = current;
+			current = next;
+		}
+	}
+
+	free(memory);
+
 	// Preventing useless symmetric representation:
 	if (SYMMETRY_PREVENTION && new_path[1] > new_path[length - 1])
 		swap(new_path, 1, length - 1);
+
+	setGeneLength(map, gene_tofill, SYMMETRY_PREVENTION ? pathLength(map, new_path) :
+		getGeneLength(map, gene_1) + best_delta);
 }
 
 
@@ -196,6 +875,21 @@ void mutation_0(const void *context, void *rng, void *gene, long epoch)
 }
 
 
+// Sum of the lengths of the edges leaving the indexes 0 < i < j of the path, each one counted once:
+static double edgesAround(const Map *map, const int *path, int i, int j)
+{
+	const int next_j = j == map -> CitiesNumber - 1 ? 0 : j + 1;
+
+	double sum = getDistance(map, path[i - 1], path[i]) + getDistance(map, path[i], path[i + 1])
+		+ getDistance(map, path[j], path[next_j]);
+
+	if (j > i + 1)
+		sum += getDistance(map, path[j - 1], path[j]);
+
+	return sum;
+}
+
+
 void mutation_1(const void *context, void *rng, void *gene, long epoch)
 {
 	const Map *map = (Map*) context;
@@ -223,10 +917,28 @@ void mutation_1(const void *context, void *rng, void *gene, long epoch)
 		city_2 = 1 + rng32_nextInt(rng) % (length - 1);
 	}
 
-	swap(new_path, city_1, city_2);
+	if (city_1 == city_2)
+		return;
+
+	const int i = city_1 < city_2 ? city_1 : city_2, j = city_1 < city_2 ? city_2 : city_1;
+
+	const double old_edges = edgesAround(map, new_path, i, j);
+
+	swap(new_path, i, j);
+
+	setGeneLength(map, gene, getGeneLength(map, gene) + edgesAround(map, new_path, i, j) - old_edges);
+}
+
+
+// Updates the length of the gene after a move, from its delta (old length - new length). Mirrored subpaths
+// change length on asymmetric maps, which the delta misses: the length is then computed again.
+static inline void updateGeneLength(const Map *map, void *gene, double delta)
+{
+	setGeneLength(map, gene, SYMMETRIC_TSP ? getGeneLength(map, gene) - delta : pathLength(map, (int*) gene));
 }
 
 
+// 2-opt move:
 void mutation_2(const void *context, void *rng, void *gene, long epoch)
 {
 	const Map *map = (Map*) context;
@@ -244,7 +956,87 @@ void mutation_2(const void *context, void *rng, void *gene, long epoch)
 	if (SYMMETRY_PREVENTION && city_1 == 1 && new_path[city_2] > new_path[1])
 		++city_1; // To not lose a mutation!
 
+	const Move move = {.start = city_1, .end = city_2, .insertion = -1};
+	const double delta = moveDelta(map, new_path, &move);
+
 	mirror(new_path, city_1, city_2);
+
+	updateGeneLength(map, gene, delta);
+}
+
+
+// Or-opt move: a segment of up to OR_OPT_MAX_LENGTH cities is moved elsewhere, and may be reversed.
+void mutation_3(const void *context, void *rng, void *gene, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *new_path = (int*) gene;
+
+	const int max_length = length - 2 < OR_OPT_MAX_LENGTH ? length - 2 : OR_OPT_MAX_LENGTH;
+
+	if (max_length < 1)
+		return;
+
+	const int segment_length = 1 + rng32_nextInt(rng) % max_length;
+
+	Move move;
+
+	move.start = 1 + rng32_nextInt(rng) % (length - segment_length); // First city fixed!
+	move.end = move.start + segment_length - 1;
+	move.insertion = rng32_nextInt(rng) % (length - segment_length - 1);
+	move.reversed = rng32_nextInt(rng) % 2;
+
+	if (move.insertion >= move.start - 1)
+		move.insertion += segment_length + 1;
+
+	const double delta = moveDelta(map, new_path, &move);
+
+	applyMove(new_path, NULL, &move);
+
+	updateGeneLength(map, gene, delta);
+}
+
+
+// Double-bridge move: the path A B C D becomes A C B D, which 2-opt and Or-opt moves can't easily undo.
+void mutation_4(const void *context, void *rng, void *gene, long epoch)
+{
+	const Map *map = (Map*) context;
+	const int length = map -> CitiesNumber;
+	int *new_path = (int*) gene;
+
+	if (length < 4)
+		return;
+
+	// Starts of B, C and D, the first city being fixed:
+	int cuts[3];
+
+	do
+	{
+		for (int k = 0; k < 3; ++k)
+			cuts[k] = 1 + rng32_nextInt(rng) % (length - 1);
+	}
+	while (cuts[0] == cuts[1] || cuts[1] == cuts[2] || cuts[0] == cuts[2]);
+
+	for (int k = 1; k < 3; ++k)
+	{
+		for (int l = k; l > 0 && cuts[l - 1] > cuts[l]; --l)
+			swap(cuts, l - 1, l);
+	}
+
+	const int b = cuts[0], c = cuts[1], d = cuts[2];
+
+	const double old_edges = getDistance(map, new_path[b - 1], new_path[b]) + getDistance(map, new_path[c - 1],
+		new_path[c]) + getDistance(map, new_path[d - 1], new_path[d]);
+
+	const double new_edges = getDistance(map, new_path[b - 1], new_path[c]) + getDistance(map, new_path[d - 1],
+		new_path[b]) + getDistance(map, new_path[c - 1], new_path[d]);
+
+	// Swapping B and C, with three mirrorings:
+	mirror(new_path, b, d - 1);
+	mirror(new_path, b, b + d - c - 1);
+	mirror(new_path, b + d - c, d - 1);
+
+	setGeneLength(map, gene, getGeneLength(map, gene) + new_edges - old_edges);
 }
 
 
@@ -253,6 +1045,7 @@ const GeneticMethods GeneMeth_salesman_1 =
 	.createGene = createGene,
 	.copyGene = copyGene,
 	.destroyGene = destroyGene,
+	.initGene = initGene,
 	.fitness = fitness,
 	.crossover = crossover_0,
 	.mutation = mutation_2,
@@ -268,6 +1061,7 @@ const GeneticMethods GeneMeth_salesman_2 =
 	.createGene = createGene,
 	.copyGene = copyGene,
 	.destroyGene = destroyGene,
+	.initGene = initGene,
 	.fitness = fitness,
 	.crossover = crossover_2,
 	.mutation = mutation_2,
@@ -283,6 +1077,7 @@ const GeneticMethods GeneMeth_salesman_3 =
 	.createGene = createGene,
 	.copyGene = copyGene,
 	.destroyGene = destroyGene,
+	.initGene = initGene,
 	.fitness = fitness,
 	.crossover = crossover_3,
 	.mutation = mutation_2,
@@ -293,9 +1088,97 @@ const GeneticMethods GeneMeth_salesman_3 =
 };
 
 
+// Order crossover (OX):
+const GeneticMethods GeneMeth_salesman_4 =
+{
+	.createGene = createGene,
+	.copyGene = copyGene,
+	.destroyGene = destroyGene,
+	.initGene = initGene,
+	.fitness = fitness,
+	.crossover = crossover_4,
+	.mutation = mutation_2,
+	.setFitnessUpdateStatus = NULL,
+
+	.selectionMode = SEL_UNIFORM
+};
+
+
+// Partially mapped crossover (PMX):
+const GeneticMethods GeneMeth_salesman_5 =
+{
+	.createGene = createGene,
+	.copyGene = copyGene,
+	.destroyGene = destroyGene,
+	.initGene = initGene,
+	.fitness = fitness,
+	.crossover = crossover_5,
+	.mutation = mutation_2,
+	.setFitnessUpdateStatus = NULL,
+
+	.selectionMode = SEL_UNIFORM
+};
+
+
+// Cycle crossover (CX):
+const GeneticMethods GeneMeth_salesman_6 =
+{
+	.createGene = createGene,
+	.copyGene = copyGene,
+	.destroyGene = destroyGene,
+	.initGene = initGene,
+	.fitness = fitness,
+	.crossover = crossover_6,
+	.mutation = mutation_2,
+	.setFitnessUpdateStatus = NULL,
+
+	.selectionMode = SEL_UNIFORM
+};
+
+
+// Edge assembly crossover (EAX). Much stronger than the other crossovers, no mutation needed, but starting from
+// fully random genes for diversity. Build candidate lists first (see initCandidates()), for subtours merging to be fast:
+const GeneticMethods GeneMeth_salesman_7 =
+{
+	.createGene = createRandomGene,
+	.copyGene = copyGene,
+	.destroyGene = destroyGene,
+	.initGene = initRandomGene,
+	.fitness = fitness,
+	.crossover = crossover_7,
+	.mutation = mutation_0,
+	.setFitnessUpdateStatus = NULL,
+
+	.selectionMode = SEL_UNIFORM,
+
+	// Replacing the worst gene quickly fills the population with clones, from which EAX can't build anything:
+	.restartPolicy = {.minRelativeDeviation = 0.001, .eliteNumber = 16}
+};
+
+
+// GeneMeth_salesman_1, restarted on stagnation. Without crossover, the population quickly collapses to near-clones:
+const GeneticMethods GeneMeth_salesman_8 =
+{
+	.createGene = createGene,
+	.copyGene = copyGene,
+	.destroyGene = destroyGene,
+	.initGene = initGene,
+	.fitness = fitness,
+	.crossover = crossover_0,
+	.mutation = mutation_2,
+	.setFitnessUpdateStatus = NULL,
+
+	.selectionMode = SEL_UNIFORM,
+
+	.restartPolicy = {.stagnationEpochs = 200000, .eliteNumber = 4, .perturbationNumber = 3}
+};
+
+
 // N.B:
-// .crossover = crossover_1, // slow...
+// .crossover = crossover_1, // linear time, but not tuned as a preset yet.
 // .mutation = mutation_0, // terrible
 // .mutation = mutation_1, // terrible
+// .mutation = mutation_3, // Or-opt moves, not tuned as a preset yet.
+// .mutation = mutation_4, // double-bridge moves, idem.
 
 // Compiling with -Wunused-function will remove the 'unused static function' warning.
@@ -2,6 +2,8 @@
 #define SALES_GEN_H
 
 
+#include <stddef.h>
+
 #include "GenLib.h"
 #include "salesman.h"
 #include "rng32.h" // necessary to be put here, for total inlining.
@@ -9,10 +11,54 @@
 
 #define FITNESS_SCALE 10000. // arbitrary.
 
+#define EAX_TRIES 10 // AB-cycles tried by the EAX crossover, the best resulting child being kept.
+
 
 extern const GeneticMethods GeneMeth_salesman_1;
 extern const GeneticMethods GeneMeth_salesman_2;
 extern const GeneticMethods GeneMeth_salesman_3;
+extern const GeneticMethods GeneMeth_salesman_4; // OX crossover.
+extern const GeneticMethods GeneMeth_salesman_5; // PMX crossover.
+extern const GeneticMethods GeneMeth_salesman_6; // CX crossover.
+extern const GeneticMethods GeneMeth_salesman_7; // EAX crossover.
+extern const GeneticMethods GeneMeth_salesman_8; // GeneMeth_salesman_1, with restarts.
+
+
+// Genes are paths followed by their length, aligned as a double. The genetic operators keep the latter up to date,
+// so that the fitness is read in O(1). Size in bytes of such genes, e.g for joinArchipelago():
+size_t salesmanGeneSize(const Map *map);
+
+
+// Creates a species whose first genes are copies of the given paths (e.g read with readTour()), the others being
+// created by the genetic methods. Warm starts the search from known solutions. Returns NULL on failure.
+Species* createSalesmanSpecies(const GeneticMethods *genMeth, const Map *map, int population_size, int **seed_paths,
+	int seed_paths_number);
+
+
+// Index of the length of a gene, counted in doubles:
+static inline size_t geneLengthIndex(const Map *map)
+{
+	return (map -> CitiesNumber * sizeof(int) + sizeof(double) - 1) / sizeof(double);
+}
+
+
+static inline double getGeneLength(const Map *map, const void *gene)
+{
+	return ((const double*) gene)[geneLengthIndex(map)];
+}
+
+
+static inline void setGeneLength(const Map *map, void *gene, double length)
+{
+	((double*) gene)[geneLengthIndex(map)] = length;
+}
+
+
+// Fitness of the genes of the given length, e.g to set the target fitness of a species from a target length:
+static inline double salesmanFitness(double length)
+{
+	return FITNESS_SCALE / length;
+}
 
 
 // Obtains uniformly (i, j) such as: 0 <= i < j < n.
@@ -55,4 +101,17 @@ static inline void mirror(int *array, int start, int end)
 }
 
 
+// Mirror the values between start and end, while keeping track of their positions
+// in 'positions', indexed by value. Needed: start <= end.
+static inline void mirrorWithPositions(int *array, int *positions, int start, int end)
+{
+	for (int i = start, j = end; i < j; ++i, --j)
+	{
+		swap(array, i, j);
+		positions[array[i]] = i;
+		positions[array[j]] = j;
+	}
+}
+
+
 #endif
@@ -1,10 +1,19 @@
+#define _POSIX_C_SOURCE 200809L // for munmap().
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include <sys/mman.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 #include "salesman.h"
 #include "matrix.h"
+#include "kd_tree.h"
+#include "construction.h" // for spaceFillingOrder()
 #include "sales_gen.h" // for swap()
 #include "get_time.h" // for create_seed()
 
@@ -18,36 +27,126 @@ inline num_map distance(num_map x1, num_map y1, num_map x2, num_map y2)
 }
 
 
+// Latitude or longitude in radians, from TSPLIB's DDD.MM format:
+static inline double geoRadians(double x)
+{
+	const double degrees = (int) x;
+
+	return 3.141592 * (degrees + 5. * (x - degrees) / 3.) / 180.; // TSPLIB's value of pi.
+}
+
+
+// Distance of a map whose weight type isn't EUC_2D, not clamped to the storage type.
+double tsplibDistance(const Map *map, int city_1, int city_2)
+{
+	if (map -> WeightType == EXPLICIT)
+		return map -> Net[netIndex(map -> NetStride, city_1, city_2)];
+
+	if (city_1 == city_2) // GEO would give 1.
+		return 0.;
+
+	const double x1 = map -> Locations[0][city_1], y1 = map -> Locations[1][city_1];
+	const double x2 = map -> Locations[0][city_2], y2 = map -> Locations[1][city_2];
+
+	if (map -> WeightType == GEO)
+	{
+		const double latitude_1 = geoRadians(x1), longitude_1 = geoRadians(y1);
+		const double latitude_2 = geoRadians(x2), longitude_2 = geoRadians(y2);
+
+		const double q1 = cos(longitude_1 - longitude_2);
+		const double q2 = cos(latitude_1 - latitude_2);
+		const double q3 = cos(latitude_1 + latitude_2);
+
+		return (int) (6378.388 * acos(0.5 * ((1. + q1) * q2 - (1. - q1) * q3)) + 1.);
+	}
+
+	const double squared_dist = (x1 - x2) * (x1 - x2) + (y1 - y2) * (y1 - y2);
+
+	if (map -> WeightType == ATT) // pseudo-euclidean distance.
+	{
+		const double dist = sqrt(squared_dist / 10.);
+		const int rounded = (int) (dist + 0.5);
+
+		return rounded < dist ? rounded + 1 : rounded;
+	}
+
+	return ceil(sqrt(squared_dist)); // CEIL_2D
+}
+
+
 Map* createMap(int citiesNumber, FillingMode fillMode, DistanceRounding distMode)
 {
 	Map *map = (Map*) calloc(1, sizeof(Map));
 
 	*(int*) &(map -> CitiesNumber) = citiesNumber;
 
-	map -> Locations = createFloatMatrix(citiesNumber, 2);
+	map -> Locations = createFloatMatrix(2, citiesNumber);
+
+	if (citiesNumber <= MATRIX_MAX_CITIES)
+		map -> Net = createNet(citiesNumber, &(map -> NetStride));
 
-	map -> Net = createFloatMatrix(citiesNumber, citiesNumber);
+	map -> Rounding = distMode;
 
-	initMap(map, fillMode, distMode);
+	if (fillMode == RANDOM)
+		initMap(map, fillMode, distMode);
 
 	return map;
 }
 
 
+// Returns 1 if the given array belongs to the memory mapped cache of the map, if any:
+static inline int isMapped(const Map *map, const void *array)
+{
+	return map -> Mapping && (const char*) array >= (const char*) map -> Mapping
+		&& (const char*) array < (const char*) map -> Mapping + map -> MappingSize;
+}
+
+
 // Passed by address:
 void freeMap(Map **map)
 {
 	if (!*map || !map)
 		return;
 
-	freeFloatMatrix((*map) -> Locations, (*map) -> CitiesNumber);
-	freeFloatMatrix((*map) -> Net, (*map) -> CitiesNumber);
+	if (isMapped(*map, (*map) -> Locations[0])) // only the array of the locations rows has been allocated.
+		free((*map) -> Locations);
+	else
+		freeFloatMatrix((*map) -> Locations, 2);
+
+	if (!isMapped(*map, (*map) -> Net))
+		freeDistanceMatrix((*map) -> Net);
+
+	if (!isMapped(*map, (*map) -> Candidates))
+	{
+		free((*map) -> Candidates);
+		free((*map) -> CandidatesDistances);
+	}
+
+	if (!isMapped(*map, (*map) -> OriginalCities))
+		free((*map) -> OriginalCities);
+
+	if ((*map) -> Mapping)
+		munmap((*map) -> Mapping, (*map) -> MappingSize);
 
 	free(*map);
 	*map = NULL;
 }
 
 
+// Creates the zeroed distance matrix of a map of the given number of cities, packed if TRIANGULAR_NET, and saves its
+// row length in 'stride'. Freed with freeDistanceMatrix().
+num_dist* createNet(int cities_number, int *stride)
+{
+	if (TRIANGULAR_NET)
+	{
+		*stride = 0;
+		return createTriangularMatrix(cities_number);
+	}
+
+	return createDistanceMatrix(cities_number, cities_number, stride);
+}
+
+
 void initMap(Map *map, FillingMode fillMode, DistanceRounding distMode)
 {
 	if (map == NULL)
@@ -59,33 +158,58 @@ void initMap(Map *map, FillingMode fillMode, DistanceRounding distMode)
 		uint64_t seed = create_seed(map);
 		rng32_init(&rng, seed, 0);
 
-		randomFloatMatrix_uniform(&rng, map -> Locations, map -> CitiesNumber, 2, 0, DIST_BOUND);
+		for (int i = 0; i < map -> CitiesNumber; ++i)
+		{
+			map -> Locations[0][i] = rng32_nextFloat(&rng) * DIST_BOUND;
+			map -> Locations[1][i] = rng32_nextFloat(&rng) * DIST_BOUND;
+		}
 	}
 
+	map -> Rounding = distMode;
+
+	if (DIST_STORAGE != DIST_STORAGE_FLOAT && distMode != ROUNDED)
+		printf("\nWarning: integer distance storage, distances will be truncated.\n");
+
+	if (!map -> Net || map -> WeightType == EXPLICIT) // implicit, or already known distances.
+		return;
+
+	int overflow = 0;
+
 	for (int i = 0; i < map -> CitiesNumber; ++i)
 	{
-		for (int j = 0; j < map -> CitiesNumber; ++j)
+		const int last = TRIANGULAR_NET ? i : map -> CitiesNumber - 1; // packed matrices only hold j <= i.
+
+		for (int j = 0; j <= last; ++j)
 		{
-			if (SYMMETRIC_TSP && i > j)
+			if (SYMMETRIC_TSP && !TRIANGULAR_NET && i > j)
 			{
-				map -> Net[i][j] = map -> Net[j][i];
+				map -> Net[netIndex(map -> NetStride, i, j)] = getDistance(map, j, i);
 				continue;
 			}
 
-			num_map x1 = map -> Locations[i][0];
-			num_map y1 = map -> Locations[i][1];
+			num_map x1 = map -> Locations[0][i];
+			num_map y1 = map -> Locations[1][i];
 
-			num_map x2 = map -> Locations[j][0];
-			num_map y2 = map -> Locations[j][1];
+			num_map x2 = map -> Locations[0][j];
+			num_map y2 = map -> Locations[1][j];
 
-			num_map dist = distance(x1, y1, x2, y2);
+			num_map dist = map -> WeightType == EUC_2D ? distance(x1, y1, x2, y2) : tsplibDistance(map, i, j);
 
 			if (distMode == ROUNDED)
 				dist = (int) (dist + 0.5f); // for TSPLIB
 
-			map -> Net[i][j] = dist;
+			if (dist > NUM_DIST_MAX)
+			{
+				dist = NUM_DIST_MAX;
+				overflow = 1;
+			}
+
+			map -> Net[netIndex(map -> NetStride, i, j)] = dist;
 		}
 	}
+
+	if (overflow)
+		printf("\nWarning: some distances are too large for their storage type.\n");
 }
 
 
@@ -97,17 +221,224 @@ void printMap(const Map *map)
 	printf("\nnum_map of cities: %d\n\n", map -> CitiesNumber);
 
 	printf("Locations:\n\n");
-	printFloatMatrix(map -> Locations, map -> CitiesNumber, 2);
+
+	for (int i = 0; i < map -> CitiesNumber; ++i)
+		printf("%8.2f%8.2f\n", map -> Locations[0][i], map -> Locations[1][i]);
+
+	printf("\n");
 
 	printf("Net:\n\n");
-	printFloatMatrix(map -> Net, map -> CitiesNumber, map -> CitiesNumber);
+
+	for (int i = 0; i < map -> CitiesNumber; ++i)
+	{
+		for (int j = 0; j < map -> CitiesNumber; ++j)
+			printf("%8.2f", (double) getDistance(map, i, j));
+
+		printf("\n");
+	}
+
+	printf("\n");
 }
 
 
-void printPath(const int *path, int length)
+// Nearest cities of the given one, read from the matrix for maps without locations. Kept sorted by insertion:
+static void nearestFromMatrix(const Map *map, int city, int neighbors_number, int *neighbors)
 {
-	for (int i = 0; i < length; ++i)
-		printf("%2d, ", path[i]);
+	int found_number = 0;
+
+	for (int other = 0; other < map -> CitiesNumber; ++other)
+	{
+		const num_dist dist = getDistance(map, city, other);
+
+		if (other == city || (found_number == neighbors_number
+			&& dist >= getDistance(map, city, neighbors[neighbors_number - 1])))
+			continue;
+
+		int i = found_number < neighbors_number ? found_number++ : neighbors_number - 1;
+
+		for (; i > 0 && getDistance(map, city, neighbors[i - 1]) > dist; --i)
+			neighbors[i] = neighbors[i - 1];
+
+		neighbors[i] = other;
+	}
+}
+
+
+// Builds the list of the 'candidates_number' nearest cities of each city, in O(n log n) using a k-d tree,
+// or in O(n^2) from the matrix for EXPLICIT maps. Once built, local searches only try moves along candidate edges.
+// Returns 0 on failure.
+int initCandidates(Map *map, int candidates_number)
+{
+	if (!map || candidates_number < 1 || candidates_number >= map -> CitiesNumber)
+	{
+		printf("\nInvalid argument in 'initCandidates()'.\n\n");
+		return 0;
+	}
+
+	KdTree *tree = map -> WeightType == EXPLICIT ? NULL : createKdTree(map);
+	int *candidates = (int*) calloc((size_t) map -> CitiesNumber * candidates_number, sizeof(int));
+	num_dist *distances = (num_dist*) calloc((size_t) map -> CitiesNumber * candidates_number, sizeof(num_dist));
+	num_map *sq_distances = (num_map*) malloc(candidates_number * sizeof(num_map)); // buffer of the queries.
+
+	if ((!tree && map -> WeightType != EXPLICIT) || !candidates || !distances || !sq_distances)
+	{
+		printf("\nNot enough memory to build candidate lists.\n");
+		freeKdTree(&tree);
+		free(candidates);
+		free(distances);
+		free(sq_distances);
+		return 0;
+	}
+
+	for (int city = 0; city < map -> CitiesNumber; ++city)
+	{
+		int *neighbors = candidates + (size_t) city * candidates_number;
+
+		if (tree)
+			nearestNeighbors(tree, city, candidates_number, neighbors, sq_distances);
+		else
+			nearestFromMatrix(map, city, candidates_number, neighbors);
+
+		for (int k = 0; k < candidates_number; ++k)
+			distances[(size_t) city * candidates_number + k] = getDistance(map, city, neighbors[k]);
+	}
+
+	freeKdTree(&tree);
+	free(sq_distances);
+
+	setCandidates(map, candidates, distances, candidates_number);
+
+	return 1;
+}
+
+
+// Replaces the candidate lists of the map by the given arrays, laid out as in the map and nearest cities first,
+// which the map then owns. Used to install lists built otherwise, e.g by initAlphaCandidates().
+void setCandidates(Map *map, int *candidates, num_dist *distances, int candidates_number)
+{
+	if (!isMapped(map, map -> Candidates))
+	{
+		free(map -> Candidates);
+		free(map -> CandidatesDistances);
+	}
+
+	map -> Candidates = candidates;
+	map -> CandidatesDistances = distances;
+	map -> CandidatesNumber = candidates_number;
+}
+
+
+// Renumbers the cities along a Hilbert curve (see construction.h), so that cities close on the map have close
+// numbers: the locations and matrix rows read along a path then stay in cache. Candidate lists are renumbered
+// as well, and the original numbers kept in 'OriginalCities', paths being printed and saved with them.
+// EXPLICIT maps are left as is. Returns 0 on memory error.
+int renumberCities(Map *map)
+{
+	if (!map)
+	{
+		printf("\nInvalid argument in 'renumberCities()'.\n\n");
+		return 0;
+	}
+
+	if (map -> WeightType == EXPLICIT)
+		return 1;
+
+	const int cities_number = map -> CitiesNumber, candidates_number = map -> CandidatesNumber;
+
+	// The new city i is the old city order[i], and the old city j gets the number new_numbers[j]:
+	int *order = (int*) malloc(cities_number * sizeof(int));
+	int *new_numbers = (int*) malloc(cities_number * sizeof(int));
+	num_map **locations = createFloatMatrix(2, cities_number);
+
+	int net_stride = 0;
+	num_dist *net = map -> Net ? createNet(cities_number, &net_stride) : NULL;
+
+	int *candidates = NULL;
+	num_dist *distances = NULL;
+
+	if (candidates_number)
+	{
+		candidates = (int*) malloc((size_t) cities_number * candidates_number * sizeof(int));
+		distances = (num_dist*) malloc((size_t) cities_number * candidates_number * sizeof(num_dist));
+	}
+
+	if (!order || !new_numbers || !locations || (map -> Net && !net) || (candidates_number && (!candidates
+		|| !distances)) || !spaceFillingOrder(map, NULL, order))
+	{
+		printf("\nNot enough memory to renumber the cities.\n");
+		free(order);
+		free(new_numbers);
+		freeFloatMatrix(locations, 2);
+		freeDistanceMatrix(net);
+		free(candidates);
+		free(distances);
+		return 0;
+	}
+
+	for (int i = 0; i < cities_number; ++i)
+		new_numbers[order[i]] = i;
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const int old_city = order[i];
+
+		locations[0][i] = map -> Locations[0][old_city];
+		locations[1][i] = map -> Locations[1][old_city];
+
+		if (net)
+		{
+			const int last = TRIANGULAR_NET ? i : cities_number - 1;
+
+			for (int j = 0; j <= last; ++j)
+				net[netIndex(net_stride, i, j)] = getDistance(map, old_city, order[j]);
+		}
+
+		for (int k = 0; k < candidates_number; ++k)
+		{
+			candidates[(size_t) i * candidates_number + k] = new_numbers[getCandidates(map, old_city)[k]];
+			distances[(size_t) i * candidates_number + k] = getCandidatesDistances(map, old_city)[k];
+		}
+	}
+
+	// Composed with a previous renumbering, if any:
+	for (int i = 0; i < cities_number; ++i)
+		order[i] = originalCity(map, order[i]);
+
+	free(new_numbers);
+
+	if (isMapped(map, map -> Locations[0]))
+		free(map -> Locations);
+	else
+		freeFloatMatrix(map -> Locations, 2);
+
+	if (!isMapped(map, map -> Net))
+		freeDistanceMatrix(map -> Net);
+
+	if (!isMapped(map, map -> Candidates))
+	{
+		free(map -> Candidates);
+		free(map -> CandidatesDistances);
+	}
+
+	if (!isMapped(map, map -> OriginalCities))
+		free(map -> OriginalCities);
+
+	map -> Locations = locations;
+	map -> Net = net;
+	map -> NetStride = net ? net_stride : map -> NetStride;
+	map -> Candidates = candidates;
+	map -> CandidatesDistances = distances;
+	map -> OriginalCities = order;
+
+	return 1;
+}
+
+
+// Printed with the original numbers of the cities:
+void printPath(const Map *map, const int *path)
+{
+	for (int i = 0; i < map -> CitiesNumber; ++i)
+		printf("%2d, ", originalCity(map, path[i]));
 	printf("\n");
 }
 
@@ -128,8 +459,20 @@ void shuffle(void *rng, int *array, int len)
 
 
 // Init a path, randomly or not, starting from a valid position. First city fixed !!!
-void initPath(void *rng, int *path, int length, InitMode initMode)
+// Constructions are randomized by 'rng', which can be NULL for them. Build candidate lists first, for them to be fast.
+void initPath(const Map *map, void *rng, int *path, InitMode initMode)
 {
+	const int length = map -> CitiesNumber;
+
+	if (initMode >= NEAREST_NEIGHBOR_INIT)
+	{
+		if (constructPath(map, rng, path, initMode))
+			return;
+
+		printf("\nNot enough memory to construct a path, the trivial one is used.\n");
+		initMode = TRIVIAL_INIT;
+	}
+
 	for (int i = 0; i < length; ++i)
 		path[i] = i;
 
@@ -163,15 +506,270 @@ void initPath(void *rng, int *path, int length, InitMode initMode)
 }
 
 
-// Length of the total path, coming back to the start:
+// Copies the given path, rotated so that it starts from the first city, as every path does:
+void seedPath(int *path, const int *seed, int length)
+{
+	int start = 0;
+
+	while (start < length && seed[start] != 0)
+		++start;
+
+	if (start == length) // not a path of this map, copied as is.
+		start = 0;
+
+	memcpy(path, seed + start, (length - start) * sizeof(int));
+	memcpy(path + length - start, seed, start * sizeof(int));
+}
+
+
+// Cost of inserting 'city' between 'a' and 'b':
+static inline double insertionCost(const Map *map, int a, int city, int b)
+{
+	return (double) getDistance(map, a, city) + getDistance(map, city, b) - getDistance(map, a, b);
+}
+
+
+// Builds in 'path' (of 'map -> CitiesNumber' cities) a valid path from the 'length' given cities, e.g a tour of
+// a slightly different map: cities out of the map and duplicates are dropped, and missing cities are inserted where
+// they lengthen the path the least, among the edges of their candidates if any. Returns the number of cities
+// inserted, or -1 on memory error. 'cities' and 'path' may be the same array, if large enough for the map.
+int repairPath(const Map *map, int *path, const int *cities, int length)
+{
+	if (!map || !path || (!cities && length > 0))
+	{
+		printf("\nInvalid argument in 'repairPath()'.\n\n");
+		return -1;
+	}
+
+	const int cities_number = map -> CitiesNumber;
+
+	// The kept cities form a cycle, linked both ways. Cities out of it have no successor:
+	int *next = (int*) malloc(2 * cities_number * sizeof(int));
+
+	if (!next)
+		return -1;
+
+	int *prev = next + cities_number;
+
+	for (int city = 0; city < cities_number; ++city)
+		next[city] = -1;
+
+	int last = -1;
+
+	for (int i = 0; i < length; ++i)
+	{
+		const int city = cities[i];
+
+		if (city < 0 || city >= cities_number || next[city] >= 0)
+			continue;
+
+		if (last < 0)
+			next[city] = prev[city] = city;
+		else
+		{
+			next[city] = next[last];
+			prev[next[last]] = city;
+			next[last] = city;
+			prev[city] = last;
+		}
+
+		last = city;
+	}
+
+	int inserted_number = 0;
+
+	for (int city = 0; city < cities_number; ++city)
+	{
+		if (next[city] >= 0)
+			continue;
+
+		++inserted_number;
+
+		if (last < 0)
+		{
+			next[city] = prev[city] = last = city;
+			continue;
+		}
+
+		// Inserted after 'best', on one of the edges of its candidates in the cycle, else on any edge:
+		int best = -1;
+		double best_cost = DBL_MAX;
+
+		for (int k = 0; k < map -> CandidatesNumber; ++k)
+		{
+			const int candidate = getCandidates(map, city)[k];
+
+			if (next[candidate] < 0)
+				continue;
+
+			double cost = insertionCost(map, candidate, city, next[candidate]);
+
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best = candidate;
+			}
+
+			cost = insertionCost(map, prev[candidate], city, candidate);
+
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best = prev[candidate];
+			}
+		}
+
+		if (best < 0)
+		{
+			int a = last;
+
+			do
+			{
+				const double cost = insertionCost(map, a, city, next[a]);
+
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best = a;
+				}
+
+				a = next[a];
+			}
+			while (a != last);
+		}
+
+		next[city] = next[best];
+		prev[next[best]] = city;
+		next[best] = city;
+		prev[city] = best;
+	}
+
+	for (int i = 0, city = 0; i < cities_number; ++i, city = next[city])
+		path[i] = city;
+
+	free(next);
+
+	return inserted_number;
+}
+
+
+#ifdef __AVX2__
+// Indexes of the distances between the given cities, as netIndex() computes them. The products of packed matrices
+// are unsigned, their cities being less than 65536 when the indexes fit in 32 bits.
+static inline __m256i netIndexes(__m256i stride, __m256i from, __m256i to)
+{
+	if (TRIANGULAR_NET)
+	{
+		const __m256i high = _mm256_max_epi32(from, to), low = _mm256_min_epi32(from, to);
+		const __m256i product = _mm256_mullo_epi32(high, _mm256_add_epi32(high, _mm256_set1_epi32(1)));
+
+		return _mm256_add_epi32(_mm256_srli_epi32(product, 1), low);
+	}
+
+	return _mm256_add_epi32(_mm256_mullo_epi32(from, stride), to);
+}
+#endif
+
+
+// Length of the total path, coming back to the start. Vectorized with AVX2, by gathering 8 distances at once,
+// or 8 pairs of locations for implicit distances.
 num_map pathLength(const Map *map, const int *path)
 {
 	const int len = map -> CitiesNumber;
 
-	num_map length = map -> Net[path[len - 1]][path[0]];
+	num_map length = getDistance(map, path[len - 1], path[0]);
+	int i = 0;
+
+#ifdef __AVX2__
+	// Implicit distances, computed exactly as computeDistance() does, apart from the storage clamping:
+	if (!map -> Net && map -> WeightType == EUC_2D && sizeof(num_map) == sizeof(float)
+		&& (DIST_STORAGE == DIST_STORAGE_FLOAT || map -> Rounding == ROUNDED))
+	{
+		const float *xs = (const float*) map -> Locations[0], *ys = (const float*) map -> Locations[1];
+		const __m256 half = _mm256_set1_ps(0.5f);
+
+		__m256 sum = _mm256_setzero_ps();
+
+		for (; i + 8 < len; i += 8)
+		{
+			__m256i from = _mm256_loadu_si256((const __m256i*) (path + i));
+			__m256i to = _mm256_loadu_si256((const __m256i*) (path + i + 1));
+
+			__m256 delta_x = _mm256_sub_ps(_mm256_i32gather_ps(xs, from, sizeof(float)),
+				_mm256_i32gather_ps(xs, to, sizeof(float)));
+			__m256 delta_y = _mm256_sub_ps(_mm256_i32gather_ps(ys, from, sizeof(float)),
+				_mm256_i32gather_ps(ys, to, sizeof(float)));
+
+			__m256 dist = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(delta_x, delta_x),
+				_mm256_mul_ps(delta_y, delta_y)));
+
+			if (map -> Rounding == ROUNDED)
+				dist = _mm256_floor_ps(_mm256_add_ps(dist, half));
+
+			sum = _mm256_add_ps(sum, dist);
+		}
+
+		float partial_sums[8];
+		_mm256_storeu_ps(partial_sums, sum);
+
+		for (int k = 0; k < 8; ++k)
+			length += partial_sums[k];
+	}
+
+	// Indexes must fit in 32 bits:
+	else if (map -> Net && netSize(map) <= INT32_MAX)
+	{
+		const __m256i stride = _mm256_set1_epi32(map -> NetStride);
+
+		if (DIST_STORAGE == DIST_STORAGE_FLOAT && sizeof(num_dist) == sizeof(float))
+		{
+			__m256 sum = _mm256_setzero_ps();
+
+			for (; i + 8 < len; i += 8)
+			{
+				__m256i from = _mm256_loadu_si256((const __m256i*) (path + i));
+				__m256i to = _mm256_loadu_si256((const __m256i*) (path + i + 1));
+				__m256i index = netIndexes(stride, from, to);
+
+				sum = _mm256_add_ps(sum, _mm256_i32gather_ps((const float*) map -> Net, index, sizeof(float)));
+			}
+
+			float partial_sums[8];
+			_mm256_storeu_ps(partial_sums, sum);
+
+			for (int k = 0; k < 8; ++k)
+				length += partial_sums[k];
+		}
+
+		else if (DIST_STORAGE != DIST_STORAGE_FLOAT)
+		{
+			__m256i sum = _mm256_setzero_si256(); // 64-bit sums, to prevent overflows.
+
+			for (; i + 8 < len; i += 8)
+			{
+				__m256i from = _mm256_loadu_si256((const __m256i*) (path + i));
+				__m256i to = _mm256_loadu_si256((const __m256i*) (path + i + 1));
+				__m256i index = netIndexes(stride, from, to);
+
+				__m256i dist = _mm256_i32gather_epi32((const int*) map -> Net, index, sizeof(num_dist));
+
+				if (DIST_STORAGE == DIST_STORAGE_INT16) // keeping the low 16 bits, with their sign.
+					dist = _mm256_srai_epi32(_mm256_slli_epi32(dist, 16), 16);
+
+				sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(dist)));
+				sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(dist, 1)));
+			}
+
+			int64_t partial_sums[4];
+			_mm256_storeu_si256((__m256i*) partial_sums, sum);
+
+			length += partial_sums[0] + partial_sums[1] + partial_sums[2] + partial_sums[3];
+		}
+	}
+#endif
 
-	for (int i = 0; i < len - 1; ++i)
-		length += map -> Net[path[i]][path[i + 1]];
+	for (; i < len - 1; ++i)
+		length += getDistance(map, path[i], path[i + 1]);
 
 	return length;
 }
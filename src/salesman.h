@@ -2,6 +2,12 @@
 #define SALESMAN_H
 
 
+#include <stddef.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+
+
 // Settings:
 
 #define DEFAULT_INIT_MODE BIASED_RANDOM_INIT // *_RANDOM_INIT doesn't seem to help much...
@@ -9,35 +15,144 @@
 #define SYMMETRIC_TSP 1
 #define SYMMETRY_PREVENTION_OPTION 0 // appealing idea, but terrible in practice... Do _not_ use it!
 
+// Symmetric maps store only the lower triangle of their distance matrix, packed: half the memory and cache footprint
+// of the full matrix, for a slightly costlier index (see netIndex()). FULL_MATRIX datasets must then be symmetric.
+#define TRIANGULAR_NET_OPTION 1
+
+// Maps with more cities don't store their distance matrix, whose size is quadratic (400 MB for 10000 cities
+// in float, or 14000 when packed): distances are then computed on the fly from the locations.
+#define MATRIX_MAX_CITIES (TRIANGULAR_NET ? 14000 : 10000)
+
 
 // Other parameters:
 
 #define DIST_BOUND 20.f // arbitrary.
 
 #define SYMMETRY_PREVENTION (SYMMETRIC_TSP && SYMMETRY_PREVENTION_OPTION) // do not modify this.
+#define TRIANGULAR_NET (SYMMETRIC_TSP && TRIANGULAR_NET_OPTION) // do not modify this.
 
 #define num_map float
 // #define num_map double
 
 
+// Storage type of the distances. Integer storages are lighter and exact, but only for ROUNDED maps (TSPLIB):
+#define DIST_STORAGE_FLOAT 0 // num_map
+#define DIST_STORAGE_INT32 1
+#define DIST_STORAGE_INT16 2 // all distances must be < 32768.
+
+#define DIST_STORAGE DIST_STORAGE_FLOAT
+
+#if DIST_STORAGE == DIST_STORAGE_INT32
+	#define num_dist int32_t
+	#define NUM_DIST_MAX INT32_MAX
+#elif DIST_STORAGE == DIST_STORAGE_INT16
+	#define num_dist int16_t
+	#define NUM_DIST_MAX INT16_MAX
+#else
+	#define num_dist num_map
+	#define NUM_DIST_MAX FLT_MAX
+#endif
+
+
 typedef enum {EXACT, ROUNDED} DistanceRounding;
 typedef enum {RANDOM, CUSTOM} FillingMode;
-typedef enum {TRIVIAL_INIT, BIASED_RANDOM_INIT, FULL_RANDOM_INIT} InitMode;
+// Initial paths: random ones, or built by the construction heuristics of construction.h, which are much shorter.
+// CHRISTOFIDES_INIT matches the odd cities of the spanning tree greedily. BIASED_RANDOM_INIT is the default of searches.
+typedef enum {BIASED_RANDOM_INIT, TRIVIAL_INIT, FULL_RANDOM_INIT, NEAREST_NEIGHBOR_INIT, GREEDY_EDGE_INIT,
+	SPACE_FILLING_CURVE_INIT, CHRISTOFIDES_INIT} InitMode;
+
+
+// Distance functions of TSPLIB. EUC_2D is the euclidean distance, rounded or not (see DistanceRounding), the others
+// are rounded as TSPLIB defines them. GEO maps store the latitudes and longitudes, given as DDD.MM in degrees and
+// minutes, as x and y. EXPLICIT distances are only stored in the matrix.
+typedef enum {EUC_2D, CEIL_2D, ATT, GEO, EXPLICIT} EdgeWeightType;
 
 
 typedef struct
 {
 	const int CitiesNumber;
-	num_map **Locations; // CitiesNumber x 2
-	num_map **Net; // CitiesNumber x CitiesNumber
+	num_map **Locations; // 2 x CitiesNumber: all the x coordinates, then all the y ones.
+	num_dist *Net; // CitiesNumber x NetStride, or packed (TRIANGULAR_NET), aligned on cache lines. NULL if implicit.
+	int NetStride; // CitiesNumber, padded so that each row is aligned on cache lines. 0 for packed matrices.
+	DistanceRounding Rounding;
+	EdgeWeightType WeightType; // EUC_2D, unless loaded from a TSPLIB file of another type.
+	int CandidatesNumber; // 0 if no candidate lists have been built.
+	int *Candidates; // CitiesNumber x CandidatesNumber, nearest cities first.
+	num_dist *CandidatesDistances; // Distances to the candidates, same layout.
+	int *OriginalCities; // Number of each city in the dataset, if renumbered by renumberCities(). NULL if not.
+	void *Mapping; // Memory mapped cache holding the arrays above, then read-only (see map_cache.h). NULL if none.
+	size_t MappingSize;
 } Map;
 
 
+// Index of the distance from 'city_1' to 'city_2' in a matrix whose rows have 'stride' values. Packed matrices hold
+// the lower triangle row by row, diagonal included: the row of the greater city starts at its triangular number.
+// Branch-free, the minimum and maximum being conditional moves.
+static inline size_t netIndex(int stride, int city_1, int city_2)
+{
+	if (TRIANGULAR_NET)
+	{
+		const size_t high = city_1 > city_2 ? city_1 : city_2;
+		const size_t low = city_1 > city_2 ? city_2 : city_1;
+
+		return high * (high + 1) / 2 + low;
+	}
+
+	return (size_t) city_1 * stride + city_2;
+}
+
+
+// Number of values of the distance matrix of the map, padding included:
+static inline size_t netSize(const Map *map)
+{
+	const size_t cities_number = map -> CitiesNumber;
+
+	return TRIANGULAR_NET ? cities_number * (cities_number + 1) / 2 : cities_number * map -> NetStride;
+}
+
+
+// Distance of a map whose weight type isn't EUC_2D, not clamped to the storage type.
+double tsplibDistance(const Map *map, int city_1, int city_2);
+
+
+// Distance from 'city_1' to 'city_2', computed from the locations. Rounded for TSPLIB maps.
+static inline num_dist computeDistance(const Map *map, int city_1, int city_2)
+{
+	if (map -> WeightType != EUC_2D)
+	{
+		double dist = tsplibDistance(map, city_1, city_2);
+
+		return dist > NUM_DIST_MAX ? NUM_DIST_MAX : dist;
+	}
+
+	num_map delta_x = map -> Locations[0][city_1] - map -> Locations[0][city_2];
+	num_map delta_y = map -> Locations[1][city_1] - map -> Locations[1][city_2];
+
+	num_map dist = sqrt(delta_x * delta_x + delta_y * delta_y);
+
+	if (map -> Rounding == ROUNDED)
+		dist = (int) (dist + 0.5f);
+
+	return dist > NUM_DIST_MAX ? NUM_DIST_MAX : dist;
+}
+
+
+// Distance from 'city_1' to 'city_2', read from the matrix, or computed if there is none:
+static inline num_dist getDistance(const Map *map, int city_1, int city_2)
+{
+	if (map -> Net)
+		return map -> Net[netIndex(map -> NetStride, city_1, city_2)];
+
+	return computeDistance(map, city_1, city_2);
+}
+
+
 // Euclidean distance between (x1, y1) and (x2, y2).
 num_map distance(num_map x1, num_map y1, num_map x2, num_map y2);
 
 
-// No need to call initMap() after this if fillMode == RANDOM.
+// No need to call initMap() after this if fillMode == RANDOM, else it must be called once the map is filled.
+// Above MATRIX_MAX_CITIES, distances are implicit.
 Map* createMap(int citiesNumber, FillingMode fillMode, DistanceRounding distMode);
 
 
@@ -45,14 +160,59 @@ Map* createMap(int citiesNumber, FillingMode fillMode, DistanceRounding distMode
 void freeMap(Map **map);
 
 
-// Must be called after the map has been filled, if fillMode != RANDOM.
+// Creates the zeroed distance matrix of a map of the given number of cities, packed if TRIANGULAR_NET, and saves its
+// row length in 'stride'. Freed with freeDistanceMatrix().
+num_dist* createNet(int cities_number, int *stride);
+
+
+// Must be called after the map has been filled, if fillMode != RANDOM. Does not modify the matrix of EXPLICIT maps.
 void initMap(Map *map, FillingMode fillMode, DistanceRounding distMode);
 
 
 void printMap(const Map *map);
 
 
-void printPath(const int *path, int length);
+// Renumbers the cities along a Hilbert curve (see construction.h), so that cities close on the map have close
+// numbers: the locations and matrix rows read along a path then stay in cache. Candidate lists are renumbered
+// as well, and the original numbers kept in 'OriginalCities', paths being printed and saved with them.
+// EXPLICIT maps are left as is. Returns 0 on memory error.
+int renumberCities(Map *map);
+
+
+// Number of the given city in the dataset:
+static inline int originalCity(const Map *map, int city)
+{
+	return map -> OriginalCities ? map -> OriginalCities[city] : city;
+}
+
+
+// Builds the list of the 'candidates_number' nearest cities of each city, in O(n log n) using a k-d tree,
+// or in O(n^2) from the matrix for EXPLICIT maps. Once built, local searches only try moves along candidate edges.
+// Returns 0 on failure.
+int initCandidates(Map *map, int candidates_number);
+
+
+// Replaces the candidate lists of the map by the given arrays, laid out as in the map and nearest cities first,
+// which the map then owns. Used to install lists built otherwise, e.g by initAlphaCandidates().
+void setCandidates(Map *map, int *candidates, num_dist *distances, int candidates_number);
+
+
+// Candidate list of the given city:
+static inline const int* getCandidates(const Map *map, int city)
+{
+	return map -> Candidates + (size_t) city * map -> CandidatesNumber;
+}
+
+
+// Distances from the given city to its candidates, cached to avoid computing them again when they are implicit:
+static inline const num_dist* getCandidatesDistances(const Map *map, int city)
+{
+	return map -> CandidatesDistances + (size_t) city * map -> CandidatesNumber;
+}
+
+
+// Printed with the original numbers of the cities:
+void printPath(const Map *map, const int *path);
 
 
 // Fisher–Yates shuffle, for an array of integers:
@@ -60,7 +220,19 @@ void shuffle(void *rng, int *array, int len);
 
 
 // Init a path, randomly or not, starting from a valid position. First city fixed !!!
-void initPath(void *rng, int *path, int length, InitMode initMode);
+// Constructions are randomized by 'rng', which can be NULL for them. Build candidate lists first, for them to be fast.
+void initPath(const Map *map, void *rng, int *path, InitMode initMode);
+
+
+// Copies the given path, rotated so that it starts from the first city, as every path does:
+void seedPath(int *path, const int *seed, int length);
+
+
+// Builds in 'path' (of 'map -> CitiesNumber' cities) a valid path from the 'length' given cities, e.g a tour of
+// a slightly different map: cities out of the map and duplicates are dropped, and missing cities are inserted where
+// they lengthen the path the least, among the edges of their candidates if any. Returns the number of cities
+// inserted, or -1 on memory error. 'cities' and 'path' may be the same array, if large enough for the map.
+int repairPath(const Map *map, int *path, const int *cities, int length);
 
 
 // Length of the total path, coming back to the start:
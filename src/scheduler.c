@@ -0,0 +1,396 @@
+#define _POSIX_C_SOURCE 200809L // for pthreads.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "scheduler.h"
+#include "get_time.h"
+
+
+#define QUEUE_INITIAL_CAPACITY 64
+
+
+// Circular buffer of jobs. The owner pops the oldest job, thieves steal the newest.
+typedef struct
+{
+	SolverJob **jobs;
+	int capacity;
+	int head;
+	int size;
+	pthread_mutex_t lock;
+} JobQueue;
+
+
+typedef struct
+{
+	Scheduler *scheduler;
+	int index;
+	pthread_t thread;
+	JobQueue queue;
+
+	// Memory reused between jobs:
+	Species *species;
+	int speciesCapacity; // cities number the species genes have been created for.
+	LocalSearchWorkspace workspace;
+} Worker;
+
+
+struct Scheduler
+{
+	int workersNumber;
+	Worker *workers;
+	int nextQueue; // queues are filled in a round-robin fashion.
+	long queuedJobs; // submitted, but not started yet.
+	long pendingJobs; // submitted, but not done yet.
+	int stopping;
+	pthread_mutex_t lock;
+	pthread_cond_t jobAvailable;
+	pthread_cond_t jobsDone;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Job queues:
+
+static int pushJob(JobQueue *queue, SolverJob *job)
+{
+	pthread_mutex_lock(&(queue -> lock));
+
+	if (queue -> size == queue -> capacity)
+	{
+		int new_capacity = queue -> capacity ? 2 * queue -> capacity : QUEUE_INITIAL_CAPACITY;
+		SolverJob **new_jobs = (SolverJob**) calloc(new_capacity, sizeof(SolverJob*));
+
+		if (!new_jobs)
+		{
+			pthread_mutex_unlock(&(queue -> lock));
+			return 0;
+		}
+
+		for (int i = 0; i < queue -> size; ++i)
+			new_jobs[i] = queue -> jobs[(queue -> head + i) % queue -> capacity];
+
+		free(queue -> jobs);
+		queue -> jobs = new_jobs;
+		queue -> capacity = new_capacity;
+		queue -> head = 0;
+	}
+
+	queue -> jobs[(queue -> head + queue -> size) % queue -> capacity] = job;
+	++(queue -> size);
+
+	pthread_mutex_unlock(&(queue -> lock));
+	return 1;
+}
+
+
+// Taking the oldest job of the queue, to keep latencies low:
+static SolverJob* popJob(JobQueue *queue)
+{
+	SolverJob *job = NULL;
+
+	pthread_mutex_lock(&(queue -> lock));
+
+	if (queue -> size > 0)
+	{
+		job = queue -> jobs[queue -> head];
+		queue -> head = (queue -> head + 1) % queue -> capacity;
+		--(queue -> size);
+	}
+
+	pthread_mutex_unlock(&(queue -> lock));
+	return job;
+}
+
+
+// Taking the newest job of the queue, to not compete with its owner:
+static SolverJob* stealJob(JobQueue *queue)
+{
+	SolverJob *job = NULL;
+
+	pthread_mutex_lock(&(queue -> lock));
+
+	if (queue -> size > 0)
+	{
+		--(queue -> size);
+		job = queue -> jobs[(queue -> head + queue -> size) % queue -> capacity];
+	}
+
+	pthread_mutex_unlock(&(queue -> lock));
+	return job;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Workers:
+
+static void runGeneticJob(Worker *worker, SolverJob *job)
+{
+	const int cities_number = job -> map -> CitiesNumber;
+	Species *species = worker -> species;
+
+	// Reusing the species of the previous job when possible:
+	if (species && species -> genMeth == job -> genMeth && species -> populationSize == job -> populationSize
+		&& cities_number <= worker -> speciesCapacity && job -> genMeth -> initGene)
+	{
+		resetSpecies(species, job -> map);
+	}
+	else
+	{
+		destroySpecies(&(worker -> species));
+		worker -> species = createSpecies(job -> genMeth, job -> map, job -> populationSize);
+		worker -> speciesCapacity = cities_number;
+		species = worker -> species;
+	}
+
+	if (!species)
+	{
+		job -> bestLength = INFINITY;
+		return;
+	}
+
+	geneticStep(species, job -> epochNumber);
+
+	const int *best_path = (const int*) getBestGene(species, NULL);
+
+	job -> bestLength = pathLength(job -> map, best_path);
+
+	if (job -> bestPath)
+		memcpy(job -> bestPath, best_path, cities_number * sizeof(int));
+}
+
+
+static void runLocalSearchJob(Worker *worker, SolverJob *job)
+{
+	LocalSearchSettings settings =
+	{
+		.temperature = job -> temperature,
+		.verbose = 0,
+		.bestPath = job -> bestPath,
+		.workspace = &(worker -> workspace)
+	};
+
+	job -> bestLength = localSearch(&settings, job -> map, job -> populationSize, job -> epochNumber, job -> mode);
+}
+
+
+// Own queue first, then stealing from the others:
+static SolverJob* findJob(Worker *worker)
+{
+	Scheduler *scheduler = worker -> scheduler;
+
+	SolverJob *job = popJob(&(worker -> queue));
+
+	for (int i = 1; !job && i < scheduler -> workersNumber; ++i)
+		job = stealJob(&(scheduler -> workers[(worker -> index + i) % scheduler -> workersNumber].queue));
+
+	return job;
+}
+
+
+static void* workerLoop(void *arg)
+{
+	Worker *worker = (Worker*) arg;
+	Scheduler *scheduler = worker -> scheduler;
+
+	while (1)
+	{
+		SolverJob *job = findJob(worker);
+
+		if (job)
+		{
+			pthread_mutex_lock(&(scheduler -> lock));
+			--(scheduler -> queuedJobs);
+			pthread_mutex_unlock(&(scheduler -> lock));
+
+			double time_start = get_time();
+
+			if (job -> type == GENETIC_JOB)
+				runGeneticJob(worker, job);
+			else
+				runLocalSearchJob(worker, job);
+
+			double time_end = get_time();
+
+			job -> runTime = time_end - time_start;
+			job -> latency = time_end - job -> submissionTime;
+
+			pthread_mutex_lock(&(scheduler -> lock));
+
+			if (--(scheduler -> pendingJobs) == 0)
+				pthread_cond_broadcast(&(scheduler -> jobsDone));
+
+			pthread_mutex_unlock(&(scheduler -> lock));
+			continue;
+		}
+
+		// Nothing to do, waiting for new jobs:
+
+		pthread_mutex_lock(&(scheduler -> lock));
+
+		while (scheduler -> queuedJobs == 0 && !scheduler -> stopping)
+			pthread_cond_wait(&(scheduler -> jobAvailable), &(scheduler -> lock));
+
+		int stop = scheduler -> stopping && scheduler -> queuedJobs == 0;
+
+		pthread_mutex_unlock(&(scheduler -> lock));
+
+		if (stop)
+			break;
+	}
+
+	return NULL;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions:
+
+// Starts 'threads_number' workers.
+Scheduler* createScheduler(int threads_number)
+{
+	if (threads_number < 1)
+	{
+		printf("\nThreads number must be at least 1.\n");
+		return NULL;
+	}
+
+	Scheduler *scheduler = (Scheduler*) calloc(1, sizeof(Scheduler));
+	Worker *workers = (Worker*) calloc(threads_number, sizeof(Worker));
+
+	if (!scheduler || !workers)
+	{
+		printf("\nNot enough memory to create a scheduler.\n");
+		free(scheduler);
+		free(workers);
+		return NULL;
+	}
+
+	scheduler -> workers = workers;
+
+	pthread_mutex_init(&(scheduler -> lock), NULL);
+	pthread_cond_init(&(scheduler -> jobAvailable), NULL);
+	pthread_cond_init(&(scheduler -> jobsDone), NULL);
+
+	for (int i = 0; i < threads_number; ++i)
+	{
+		workers[i].scheduler = scheduler;
+		workers[i].index = i;
+		pthread_mutex_init(&(workers[i].queue.lock), NULL);
+	}
+
+	// Workers must know each other before starting:
+	scheduler -> workersNumber = threads_number;
+
+	for (int i = 0; i < threads_number; ++i)
+	{
+		if (pthread_create(&(workers[i].thread), NULL, workerLoop, workers + i) != 0)
+		{
+			printf("\nCould only start %d threads.\n", i);
+			scheduler -> workersNumber = i;
+			break;
+		}
+	}
+
+	if (scheduler -> workersNumber == 0)
+		destroyScheduler(&scheduler);
+
+	return scheduler;
+}
+
+
+// Waits for all submitted jobs to be done, then stops the workers. Passed by address.
+void destroyScheduler(Scheduler **scheduler_address)
+{
+	if (!scheduler_address || !*scheduler_address)
+		return;
+
+	Scheduler *scheduler = *scheduler_address;
+
+	waitJobs(scheduler);
+
+	pthread_mutex_lock(&(scheduler -> lock));
+	scheduler -> stopping = 1;
+	pthread_cond_broadcast(&(scheduler -> jobAvailable));
+	pthread_mutex_unlock(&(scheduler -> lock));
+
+	for (int i = 0; i < scheduler -> workersNumber; ++i)
+		pthread_join(scheduler -> workers[i].thread, NULL);
+
+	for (int i = 0; i < scheduler -> workersNumber; ++i)
+	{
+		Worker *worker = scheduler -> workers + i;
+
+		destroySpecies(&(worker -> species));
+		freeLocalSearchWorkspace(&(worker -> workspace));
+		free(worker -> queue.jobs);
+		pthread_mutex_destroy(&(worker -> queue.lock));
+	}
+
+	pthread_mutex_destroy(&(scheduler -> lock));
+	pthread_cond_destroy(&(scheduler -> jobAvailable));
+	pthread_cond_destroy(&(scheduler -> jobsDone));
+
+	free(scheduler -> workers);
+	free(scheduler);
+	*scheduler_address = NULL;
+}
+
+
+// Queues the given job, which must stay valid until done. Returns 0 on failure.
+int submitJob(Scheduler *scheduler, SolverJob *job)
+{
+	if (!scheduler || !job || !job -> map || (job -> type == GENETIC_JOB && !job -> genMeth))
+	{
+		printf("\nInvalid argument in 'submitJob()'.\n\n");
+		return 0;
+	}
+
+	job -> submissionTime = get_time();
+
+	// Counting the job first, so that the counters never go negative:
+	pthread_mutex_lock(&(scheduler -> lock));
+	int queue_index = scheduler -> nextQueue;
+	scheduler -> nextQueue = (queue_index + 1) % scheduler -> workersNumber;
+	++(scheduler -> pendingJobs);
+	++(scheduler -> queuedJobs);
+	pthread_mutex_unlock(&(scheduler -> lock));
+
+	int success = pushJob(&(scheduler -> workers[queue_index].queue), job);
+
+	pthread_mutex_lock(&(scheduler -> lock));
+
+	if (success)
+		pthread_cond_signal(&(scheduler -> jobAvailable));
+	else
+	{
+		printf("\nNot enough memory to queue a new job.\n");
+
+		--(scheduler -> queuedJobs);
+
+		if (--(scheduler -> pendingJobs) == 0)
+			pthread_cond_broadcast(&(scheduler -> jobsDone));
+	}
+
+	pthread_mutex_unlock(&(scheduler -> lock));
+
+	return success;
+}
+
+
+// Blocks until every submitted job is done.
+void waitJobs(Scheduler *scheduler)
+{
+	if (!scheduler)
+		return;
+
+	pthread_mutex_lock(&(scheduler -> lock));
+
+	while (scheduler -> pendingJobs > 0)
+		pthread_cond_wait(&(scheduler -> jobsDone), &(scheduler -> lock));
+
+	pthread_mutex_unlock(&(scheduler -> lock));
+}
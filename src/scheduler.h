@@ -0,0 +1,59 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+
+#include "GenLib.h"
+#include "salesman.h"
+#include "local_search.h"
+
+
+// Solving many independent TSP instances concurrently, with a fixed pool of worker threads. Each worker owns
+// a queue of jobs, and steals from the others when its own is empty, thus keeping all cores busy without
+// oversubscribing them. Species and local search memory are kept by each worker, and reused between jobs.
+
+
+typedef enum {GENETIC_JOB, LOCAL_SEARCH_JOB} JobType;
+
+
+typedef struct
+{
+	// Inputs:
+	const Map *map;
+	JobType type;
+	const GeneticMethods *genMeth; // GENETIC_JOB only.
+	localSearchMode mode; // LOCAL_SEARCH_JOB only.
+	float temperature; // for SA and TA.
+	int populationSize;
+	long epochNumber; // budget of the job.
+
+	// Outputs, valid once the job is done:
+	int *bestPath; // If not NULL, filled with the best found path.
+	double bestLength;
+	double latency; // time between the job submission and its completion, in seconds.
+	double runTime; // time spent solving the job, in seconds.
+
+	// Private:
+	double submissionTime;
+} SolverJob;
+
+
+typedef struct Scheduler Scheduler;
+
+
+// Starts 'threads_number' workers.
+Scheduler* createScheduler(int threads_number);
+
+
+// Waits for all submitted jobs to be done, then stops the workers. Passed by address.
+void destroyScheduler(Scheduler **scheduler_address);
+
+
+// Queues the given job, which must stay valid until done. Returns 0 on failure.
+int submitJob(Scheduler *scheduler, SolverJob *job);
+
+
+// Blocks until every submitted job is done.
+void waitJobs(Scheduler *scheduler);
+
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef TOUR_H
+#define TOUR_H
+
+
+#include "sales_gen.h" // for mirrorWithPositions()
+#include "two_level_list.h"
+
+
+// Path seen as a cycle, along with its inverse 'positions', indexed by city, so that the successor and predecessor
+// of a city are found in O(1). As for every path, the first city always stays at index 0.
+// If 'list' is not NULL, it is used instead of the two arrays, which aren't updated: reversals then cost O(sqrt(n))
+// instead of O(n). The path is written back with listToPath().
+typedef struct
+{
+	int *path;
+	int *positions;
+	int citiesNumber;
+	TwoLevelList *list;
+} Tour;
+
+
+static inline int tourNext(const Tour *tour, int city)
+{
+	if (tour -> list)
+		return listNext(tour -> list, city);
+
+	int index = tour -> positions[city] + 1;
+
+	return tour -> path[index == tour -> citiesNumber ? 0 : index];
+}
+
+
+static inline int tourPrev(const Tour *tour, int city)
+{
+	if (tour -> list)
+		return listPrev(tour -> list, city);
+
+	int index = tour -> positions[city] - 1;
+
+	return tour -> path[index < 0 ? tour -> citiesNumber - 1 : index];
+}
+
+
+// Returns 1 if 'b' is met when going forward from 'a' to 'c', both included.
+static inline int tourBetween(const Tour *tour, int a, int b, int c)
+{
+	if (tour -> list)
+		return listBetween(tour -> list, a, b, c);
+
+	const int pa = tour -> positions[a], pb = tour -> positions[b], pc = tour -> positions[c];
+
+	if (pa <= pc)
+		return pa <= pb && pb <= pc;
+
+	return pb >= pa || pb <= pc;
+}
+
+
+// Reverses the subpath going forward from city 'from' to city 'to'. If it contains the first index, its complement
+// is reversed instead, which gives the same cycle, travelled in the other direction.
+static inline void tourReverse(Tour *tour, int from, int to)
+{
+	if (tour -> list)
+	{
+		listReverse(tour -> list, from, to);
+		return;
+	}
+
+	int start = tour -> positions[from], end = tour -> positions[to];
+
+	if (start == 0 || start > end)
+	{
+		int temp = start;
+		start = end + 1;
+		end = (temp == 0 ? tour -> citiesNumber : temp) - 1;
+	}
+
+	if (start < end)
+		mirrorWithPositions(tour -> path, tour -> positions, start, end);
+}
+
+
+// 2-opt move removing the edges (t1, t2) and (t3, t4), and adding (t2, t3) and (t4, t1). 't2' must be the successor
+// of 't1' and 't4' the predecessor of 't3', or the other way around: see tourOpposite().
+static inline void tourMove2Opt(Tour *tour, int t1, int t2, int t3, int t4)
+{
+	if (tourNext(tour, t1) == t2)
+		tourReverse(tour, t2, t4); // t1 t2 ... t4 t3 -> t1 t4 ... t2 t3
+	else
+		tourReverse(tour, t4, t2); // t3 t4 ... t2 t1 -> t3 t2 ... t4 t1
+}
+
+
+// Neighbor of 't3' to be used with tourMove2Opt(): its predecessor if 't2' follows 't1', else its successor.
+static inline int tourOpposite(const Tour *tour, int t1, int t2, int t3)
+{
+	return tourNext(tour, t1) == t2 ? tourPrev(tour, t3) : tourNext(tour, t3);
+}
+
+
+// Moves the segment going forward from 's' to 'e' between 'a' and its successor 'b', mirrored if 'reversed'.
+// Done with at most three 2-opt moves, so that it only relies on reversals. 'a' and 'b' must be outside
+// of the segment and of its two neighbors.
+static inline void tourMoveSegment(Tour *tour, int s, int e, int a, int b, int reversed)
+{
+	const int p = tourPrev(tour, s), q = tourNext(tour, e);
+
+	tourMove2Opt(tour, p, s, b, a); // p s ... e q ... a b -> p a ... q e ... s b
+	tourMove2Opt(tour, p, a, e, q); // -> p q ... a e ... s b
+
+	if (!reversed)
+		tourMove2Opt(tour, a, e, b, s); // -> p q ... a s ... e b
+}
+
+
+#endif
@@ -0,0 +1,449 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "two_level_list.h"
+
+
+// Segments growing past this many times their initial size trigger a rebalancing of the whole list:
+#define REBALANCE_FACTOR 4
+
+
+TwoLevelList* createTwoLevelList(int capacity)
+{
+	TwoLevelList *list = (TwoLevelList*) calloc(1, sizeof(TwoLevelList));
+
+	if (!list)
+	{
+		printf("\nNot enough memory to create a two-level list.\n");
+		return NULL;
+	}
+
+	list -> capacity = capacity;
+
+	int segments_capacity = (int) sqrt(capacity) + 2;
+
+	list -> nodeNext = (int*) calloc(capacity, sizeof(int));
+	list -> nodePrev = (int*) calloc(capacity, sizeof(int));
+	list -> parent = (int*) calloc(capacity, sizeof(int));
+	list -> rank = (int*) calloc(capacity, sizeof(int));
+	list -> buffer = (int*) calloc(capacity, sizeof(int));
+
+	list -> reversed = (char*) calloc(segments_capacity, sizeof(char));
+	list -> first = (int*) calloc(segments_capacity, sizeof(int));
+	list -> last = (int*) calloc(segments_capacity, sizeof(int));
+	list -> segmentNext = (int*) calloc(segments_capacity, sizeof(int));
+	list -> segmentPrev = (int*) calloc(segments_capacity, sizeof(int));
+	list -> segmentRank = (int*) calloc(segments_capacity, sizeof(int));
+	list -> size = (int*) calloc(segments_capacity, sizeof(int));
+
+	if (!list -> nodeNext || !list -> nodePrev || !list -> parent || !list -> rank || !list -> buffer
+		|| !list -> reversed || !list -> first || !list -> last || !list -> segmentNext || !list -> segmentPrev
+		|| !list -> segmentRank || !list -> size)
+	{
+		printf("\nNot enough memory to create a two-level list.\n");
+		freeTwoLevelList(&list);
+		return NULL;
+	}
+
+	return list;
+}
+
+
+// Passed by address:
+void freeTwoLevelList(TwoLevelList **list_address)
+{
+	if (!list_address || !*list_address)
+		return;
+
+	TwoLevelList *list = *list_address;
+
+	free(list -> nodeNext);
+	free(list -> nodePrev);
+	free(list -> parent);
+	free(list -> rank);
+	free(list -> buffer);
+
+	free(list -> reversed);
+	free(list -> first);
+	free(list -> last);
+	free(list -> segmentNext);
+	free(list -> segmentPrev);
+	free(list -> segmentRank);
+	free(list -> size);
+
+	free(list);
+	*list_address = NULL;
+}
+
+
+// Builds the list from the given path.
+void listFromPath(TwoLevelList *list, const int *path, int cities_number)
+{
+	if (!list || !path || cities_number < 3 || cities_number > list -> capacity)
+	{
+		printf("\nInvalid argument in 'listFromPath()'.\n\n");
+		return;
+	}
+
+	int segments_number = (int) sqrt(cities_number);
+
+	if (segments_number < 2)
+		segments_number = 2;
+
+	const int group_size = (cities_number + segments_number - 1) / segments_number;
+	segments_number = (cities_number + group_size - 1) / group_size;
+
+	list -> citiesNumber = cities_number;
+	list -> segmentsNumber = segments_number;
+	list -> groupSize = group_size;
+
+	for (int i = 0; i < cities_number; ++i)
+	{
+		const int city = path[i], segment = i / group_size;
+
+		list -> nodeNext[city] = path[i == cities_number - 1 ? 0 : i + 1];
+		list -> nodePrev[city] = path[i == 0 ? cities_number - 1 : i - 1];
+		list -> parent[city] = segment;
+		list -> rank[city] = i % group_size;
+	}
+
+	for (int segment = 0; segment < segments_number; ++segment)
+	{
+		const int start = segment * group_size;
+		const int end = start + group_size < cities_number ? start + group_size : cities_number;
+
+		list -> reversed[segment] = 0;
+		list -> first[segment] = path[start];
+		list -> last[segment] = path[end - 1];
+		list -> segmentNext[segment] = segment == segments_number - 1 ? 0 : segment + 1;
+		list -> segmentPrev[segment] = segment == 0 ? segments_number - 1 : segment - 1;
+		list -> segmentRank[segment] = segment;
+		list -> size[segment] = end - start;
+	}
+}
+
+
+// Writes the tour in 'path', starting from city 0.
+void listToPath(const TwoLevelList *list, int *path)
+{
+	if (!list || !path)
+	{
+		printf("\nInvalid argument in 'listToPath()'.\n\n");
+		return;
+	}
+
+	int city = 0;
+
+	for (int i = 0; i < list -> citiesNumber; ++i)
+	{
+		path[i] = city;
+		city = listNext(list, city);
+	}
+}
+
+
+static inline int tourFirst(const TwoLevelList *list, int segment)
+{
+	return list -> reversed[segment] ? list -> last[segment] : list -> first[segment];
+}
+
+
+static inline int tourLast(const TwoLevelList *list, int segment)
+{
+	return list -> reversed[segment] ? list -> first[segment] : list -> last[segment];
+}
+
+
+// Index of the city in its segment, in tour order:
+static inline int tourIndex(const TwoLevelList *list, int city)
+{
+	const int segment = list -> parent[city];
+
+	return list -> reversed[segment] ? list -> size[segment] - 1 - list -> rank[city] : list -> rank[city];
+}
+
+
+// Replaces the link of 'city' to 'old_neighbor' by one to 'new_neighbor':
+static inline void replaceLink(TwoLevelList *list, int city, int old_neighbor, int new_neighbor)
+{
+	if (list -> nodeNext[city] == old_neighbor)
+		list -> nodeNext[city] = new_neighbor;
+	else
+		list -> nodePrev[city] = new_neighbor;
+}
+
+
+// Assigns contiguous ranks to the cities of the segment, whose first city in tour order is given:
+static void renumber(TwoLevelList *list, int segment, int tour_first)
+{
+	const int size = list -> size[segment];
+	const char reversed = list -> reversed[segment];
+
+	int city = tour_first;
+
+	for (int i = 0; i < size; ++i)
+	{
+		list -> rank[city] = reversed ? size - 1 - i : i;
+
+		if (i == 0)
+			*(reversed ? &list -> last[segment] : &list -> first[segment]) = city;
+
+		if (i == size - 1)
+			*(reversed ? &list -> first[segment] : &list -> last[segment]) = city;
+
+		city = listNext(list, city);
+	}
+}
+
+
+// Moves 'count' cities, starting from 'city' in tour order, to the segment 'target'. Links between cities are
+// kept, those of the moved cities being swapped if the two segments don't have the same orientation.
+static void moveCities(TwoLevelList *list, int city, int count, int target)
+{
+	const int source = list -> parent[city];
+	const int swapped = list -> reversed[source] != list -> reversed[target];
+
+	for (int i = 0; i < count; ++i)
+	{
+		const int next = listNext(list, city);
+
+		if (swapped)
+		{
+			int temp = list -> nodeNext[city];
+			list -> nodeNext[city] = list -> nodePrev[city];
+			list -> nodePrev[city] = temp;
+		}
+
+		list -> parent[city] = target;
+		city = next;
+	}
+
+	list -> size[source] -= count;
+	list -> size[target] += count;
+}
+
+
+// Moves the cities of the segment of 'city' preceding it to the end of the previous segment.
+static void moveHeadToPrevious(TwoLevelList *list, int city)
+{
+	const int segment = list -> parent[city];
+	const int previous = list -> segmentPrev[segment];
+	const int previous_first = tourFirst(list, previous);
+
+	moveCities(list, tourFirst(list, segment), tourIndex(list, city), previous);
+
+	renumber(list, previous, previous_first);
+	renumber(list, segment, city);
+}
+
+
+// Moves the cities of the segment of 'city' from it to its end, to the start of the next segment.
+static void moveTailToNext(TwoLevelList *list, int city)
+{
+	const int segment = list -> parent[city];
+	const int next = list -> segmentNext[segment];
+	const int segment_first = tourFirst(list, segment);
+
+	moveCities(list, city, list -> size[segment] - tourIndex(list, city), next);
+
+	renumber(list, next, city);
+	renumber(list, segment, segment_first);
+}
+
+
+// Makes 'city' the first one of its segment in tour order, moving the fewest cities.
+static void splitBefore(TwoLevelList *list, int city)
+{
+	const int segment = list -> parent[city];
+	const int index = tourIndex(list, city);
+
+	if (index == 0)
+		return;
+
+	if (index <= list -> size[segment] / 2)
+		moveHeadToPrevious(list, city);
+	else
+		moveTailToNext(list, city);
+}
+
+
+// Makes 'city' the last one of its segment in tour order, without moving cities to 'kept_segment'.
+static void splitAfter(TwoLevelList *list, int city, int kept_segment)
+{
+	const int segment = list -> parent[city];
+	const int index = tourIndex(list, city);
+	const int tail_size = list -> size[segment] - 1 - index;
+
+	if (tail_size == 0)
+		return;
+
+	if (tail_size <= index && list -> segmentNext[segment] != kept_segment)
+		moveTailToNext(list, listNext(list, city));
+	else
+		moveHeadToPrevious(list, listNext(list, city));
+}
+
+
+// Reverses the subpath from 'from' to 'to', both in the same segment, 'from' coming first.
+static void reverseInside(TwoLevelList *list, int from, int to)
+{
+	const int segment = list -> parent[from];
+
+	// Storage order:
+	const int low = list -> reversed[segment] ? to : from;
+	const int high = list -> reversed[segment] ? from : to;
+
+	const int outer_prev = list -> nodePrev[low], outer_next = list -> nodeNext[high];
+	const int rank_sum = list -> rank[low] + list -> rank[high];
+
+	int city = low;
+
+	while (1)
+	{
+		const int next = list -> nodeNext[city];
+
+		list -> nodeNext[city] = list -> nodePrev[city];
+		list -> nodePrev[city] = next;
+		list -> rank[city] = rank_sum - list -> rank[city];
+
+		if (city == high)
+			break;
+
+		city = next;
+	}
+
+	list -> nodeNext[low] = outer_next;
+	list -> nodePrev[high] = outer_prev;
+
+	if (outer_prev == outer_next) // single city left out.
+	{
+		int temp = list -> nodeNext[outer_prev];
+		list -> nodeNext[outer_prev] = list -> nodePrev[outer_prev];
+		list -> nodePrev[outer_prev] = temp;
+	}
+	else
+	{
+		replaceLink(list, outer_prev, low, high);
+		replaceLink(list, outer_next, high, low);
+	}
+
+	if (list -> first[segment] == low)
+		list -> first[segment] = high;
+
+	if (list -> last[segment] == high)
+		list -> last[segment] = low;
+}
+
+
+// Reverses the order of the segments from 'first' to 'last', which must not contain the whole tour, nor go past
+// the last segment. Their bits are flipped, so that only the four links at the ends need to be updated.
+static void reverseSegments(TwoLevelList *list, int first, int last)
+{
+	const int from = tourFirst(list, first), to = tourLast(list, last);
+
+	if (from == to)
+		return;
+
+	const int outer_prev = listPrev(list, from), outer_next = listNext(list, to);
+	const int segment_prev = list -> segmentPrev[first], segment_next = list -> segmentNext[last];
+	const int rank_sum = list -> segmentRank[first] + list -> segmentRank[last];
+
+	int segment = first;
+
+	while (1)
+	{
+		const int next = list -> segmentNext[segment];
+
+		list -> segmentNext[segment] = list -> segmentPrev[segment];
+		list -> segmentPrev[segment] = next;
+		list -> segmentRank[segment] = rank_sum - list -> segmentRank[segment];
+		list -> reversed[segment] ^= 1;
+
+		if (segment == last)
+			break;
+
+		segment = next;
+	}
+
+	list -> segmentNext[segment_prev] = last;
+	list -> segmentPrev[last] = segment_prev;
+	list -> segmentNext[first] = segment_next;
+	list -> segmentPrev[segment_next] = first;
+
+	// Links inside the reversed subpath are still valid, for they are now read the other way:
+
+	if (outer_prev == outer_next)
+	{
+		int temp = list -> nodeNext[outer_prev];
+		list -> nodeNext[outer_prev] = list -> nodePrev[outer_prev];
+		list -> nodePrev[outer_prev] = temp;
+	}
+	else
+	{
+		replaceLink(list, outer_prev, from, to);
+		replaceLink(list, outer_next, to, from);
+	}
+
+	replaceLink(list, from, outer_prev, outer_next);
+	replaceLink(list, to, outer_next, outer_prev);
+}
+
+
+static void rebalance(TwoLevelList *list)
+{
+	listToPath(list, list -> buffer);
+	listFromPath(list, list -> buffer, list -> citiesNumber);
+}
+
+
+// Reverses the subpath going forward from city 'from' to city 'to'. Its complement may be reversed instead,
+// which gives the same cycle, travelled in the other direction.
+void listReverse(TwoLevelList *list, int from, int to)
+{
+	if (from == to)
+		return;
+
+	const int max_size = REBALANCE_FACTOR * list -> groupSize;
+
+	if (list -> size[list -> parent[from]] > max_size || list -> size[list -> parent[to]] > max_size)
+		rebalance(list);
+
+	if (list -> parent[from] == list -> parent[to])
+	{
+		if (listBefore(list, from, to))
+		{
+			reverseInside(list, from, to);
+			return;
+		}
+
+		// The subpath goes around the whole tour, and its complement lies inside the segment:
+		const int complement_from = listNext(list, to), complement_to = listPrev(list, from);
+
+		if (complement_from != from && complement_from != complement_to)
+			reverseInside(list, complement_from, complement_to);
+
+		return;
+	}
+
+	splitBefore(list, from);
+
+	if (list -> parent[from] == list -> parent[to]) // 'from' has been moved to the segment of 'to'.
+	{
+		reverseInside(list, from, to);
+		return;
+	}
+
+	splitAfter(list, to, list -> parent[from]);
+
+	const int first = list -> parent[from], last = list -> parent[to];
+
+	if (list -> segmentNext[last] == first) // whole tour.
+		return;
+
+	if (list -> segmentRank[first] <= list -> segmentRank[last])
+		reverseSegments(list, first, last);
+
+	else // the complement doesn't go past the last segment.
+		reverseSegments(list, list -> segmentNext[last], list -> segmentPrev[first]);
+}
@@ -0,0 +1,93 @@
+#ifndef TWO_LEVEL_LIST_H
+#define TWO_LEVEL_LIST_H
+
+
+// Tour stored as a two-level doubly-linked list: cities are linked to their neighbors, and grouped in about sqrt(n)
+// segments, themselves linked together. Each segment has a reversal bit, so that reversing a subpath only needs
+// to split at most two segments, then to reverse the order of the segments in between and flip their bits.
+// Successor, predecessor and 'between' queries are O(1), reversals O(sqrt(n)), instead of O(n) for arrays.
+//
+// Each city stores its neighbors in the storage order of its segment, which is the tour order unless the segment
+// is reversed. Ranks are kept contiguous in each segment, from 0 to its size - 1, in storage order.
+typedef struct
+{
+	int citiesNumber;
+	int capacity;
+	int segmentsNumber;
+	int groupSize; // initial size of the segments.
+
+	// Per city:
+	int *nodeNext;
+	int *nodePrev;
+	int *parent;
+	int *rank;
+
+	// Per segment:
+	char *reversed;
+	int *first; // in storage order.
+	int *last;
+	int *segmentNext; // in tour order.
+	int *segmentPrev;
+	int *segmentRank; // increasing in tour order, from the first segment.
+	int *size;
+
+	int *buffer; // used when rebalancing the segments.
+} TwoLevelList;
+
+
+// Can hold tours of up to 'capacity' cities.
+TwoLevelList* createTwoLevelList(int capacity);
+
+
+// Passed by address:
+void freeTwoLevelList(TwoLevelList **list_address);
+
+
+// Builds the list from the given path.
+void listFromPath(TwoLevelList *list, const int *path, int cities_number);
+
+
+// Writes the tour in 'path', starting from city 0.
+void listToPath(const TwoLevelList *list, int *path);
+
+
+// Reverses the subpath going forward from city 'from' to city 'to'. Its complement may be reversed instead,
+// which gives the same cycle, travelled in the other direction.
+void listReverse(TwoLevelList *list, int from, int to);
+
+
+static inline int listNext(const TwoLevelList *list, int city)
+{
+	return list -> reversed[list -> parent[city]] ? list -> nodePrev[city] : list -> nodeNext[city];
+}
+
+
+static inline int listPrev(const TwoLevelList *list, int city)
+{
+	return list -> reversed[list -> parent[city]] ? list -> nodeNext[city] : list -> nodePrev[city];
+}
+
+
+// Returns 1 if 'a' is before 'b', or equal, when going forward from the first segment.
+static inline int listBefore(const TwoLevelList *list, int a, int b)
+{
+	const int segment_a = list -> parent[a], segment_b = list -> parent[b];
+
+	if (segment_a != segment_b)
+		return list -> segmentRank[segment_a] < list -> segmentRank[segment_b];
+
+	return list -> reversed[segment_a] ? list -> rank[a] >= list -> rank[b] : list -> rank[a] <= list -> rank[b];
+}
+
+
+// Returns 1 if 'b' is met when going forward from 'a' to 'c', both included.
+static inline int listBetween(const TwoLevelList *list, int a, int b, int c)
+{
+	if (listBefore(list, a, c))
+		return listBefore(list, a, b) && listBefore(list, b, c);
+
+	return listBefore(list, a, b) || listBefore(list, b, c);
+}
+
+
+#endif